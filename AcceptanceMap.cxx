@@ -0,0 +1,278 @@
+/**
+ * @file   AcceptanceMap.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 19 10:58:22 2026
+ *
+ * @brief  Implementation of AcceptanceMap
+ *
+ *
+ */
+
+// STL headers
+#include <algorithm>
+
+// ROOT headers
+#include <TRandom.h>
+#include <TH2D.h>
+
+// package headers
+#include "AcceptanceMap.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long AcceptanceMap::_count(0);
+
+
+AcceptanceMap::AcceptanceMap(unsigned npbins, double pmin, double pmax,
+			     unsigned netabins, double etamin, double etamax)
+{
+  _nbins[0] = npbins;
+  _nbins[1] = netabins;
+  _min[0] = pmin;
+  _min[1] = etamin;
+  _max[0] = pmax;
+  _max[1] = etamax;
+
+  _ntried.resize(npbins * netabins, 0.0);
+  _npassed.resize(npbins * netabins, 0.0);
+}
+
+
+AcceptanceMap::AcceptanceMap(TH1 *hmomp, TH1 *hmomn)
+{
+  _nbins[0] = hmomp->GetNbinsX();
+  _nbins[1] = hmomn->GetNbinsX();
+  _min[0] = hmomp->GetXaxis()->GetXmin();
+  _min[1] = hmomn->GetXaxis()->GetXmin();
+  _max[0] = hmomp->GetXaxis()->GetXmax();
+  _max[1] = hmomn->GetXaxis()->GetXmax();
+
+  _ntried.resize(_nbins[0] * _nbins[1], 0.0);
+  _npassed.resize(_nbins[0] * _nbins[1], 0.0);
+}
+
+
+bool AcceptanceMap::check_templates(TH1 *hmomp, TH1 *hmomn)
+{
+  TH1 *templates[2] = {hmomp, hmomn};
+  for (unsigned i = 0; i < 2; ++i) {
+    if (templates[i]->GetXaxis()->IsVariableBinSize()) {
+      ERROR("Template " << templates[i]->GetName() << " has variable bin "
+	    "widths, not supported by acceptance maps.");
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool AcceptanceMap::find_bin(double p, double eta, unsigned &ip,
+			     unsigned &ieta) const
+{
+  if (p < _min[0] or not (p < _max[0]) or
+      eta < _min[1] or not (eta < _max[1])) {
+    return false;
+  }
+  ip = (p - _min[0]) / (_max[0] - _min[0]) * _nbins[0];
+  ieta = (eta - _min[1]) / (_max[1] - _min[1]) * _nbins[1];
+  // guard against rounding at the upper edge
+  ip = std::min(ip, _nbins[0] - 1);
+  ieta = std::min(ieta, _nbins[1] - 1);
+  return true;
+}
+
+
+void AcceptanceMap::fill(double p, double eta, bool accepted)
+{
+  unsigned ip(0), ieta(0);
+  if (not find_bin(p, eta, ip, ieta)) return;
+
+  const unsigned bin(ip * _nbins[1] + ieta);
+  _ntried[bin] += 1.0;
+  if (accepted) _npassed[bin] += 1.0;
+  return;
+}
+
+
+double AcceptanceMap::get_efficiency(double p, double eta) const
+{
+  unsigned ip(0), ieta(0);
+  if (not find_bin(p, eta, ip, ieta)) return 0.0;
+
+  const unsigned bin(ip * _nbins[1] + ieta);
+  if (_ntried[bin] > 0.0) {
+    return _npassed[bin] / _ntried[bin];
+  }
+  return 0.0;
+}
+
+
+double AcceptanceMap::get_efficiency() const
+{
+  double ntried(0.0), npassed(0.0);
+  for (unsigned bin = 0; bin < _ntried.size(); ++bin) {
+    ntried += _ntried[bin];
+    npassed += _npassed[bin];
+  }
+  return ntried > 0.0 ? npassed / ntried : 0.0;
+}
+
+
+double AcceptanceMap::get_efficiency(TH1 *hmomp, TH1 *hmomn) const
+{
+  if (not check_templates(hmomp, hmomn)) return 0.0;
+
+  double fnorm(0.0), npassed(0.0);
+  const double pwidth((_max[0] - _min[0]) / _nbins[0]),
+    etawidth((_max[1] - _min[1]) / _nbins[1]);
+  for (unsigned ip = 0; ip < _nbins[0]; ++ip) {
+    double fp(hmomp->GetBinContent(hmomp->GetXaxis()->
+				   FindFixBin(_min[0] + (ip + 0.5) * pwidth)));
+    for (unsigned ieta = 0; ieta < _nbins[1]; ++ieta) {
+      double feta(hmomn->GetBinContent(hmomn->GetXaxis()->
+				       FindFixBin(_min[1] + (ieta + 0.5) * etawidth)));
+      const unsigned bin(ip * _nbins[1] + ieta);
+      double f(std::max(fp, 0.0) * std::max(feta, 0.0));
+      fnorm += f;
+      if (_ntried[bin] > 0.0) npassed += f * _npassed[bin] / _ntried[bin];
+    }
+  }
+  return fnorm > 0.0 ? npassed / fnorm : 0.0;
+}
+
+
+bool AcceptanceMap::build_sampler(TH1 *hmomp, TH1 *hmomn, double floor)
+{
+  if (not check_templates(hmomp, hmomn)) return false;
+
+  const unsigned nbins(_nbins[0] * _nbins[1]);
+  std::vector<double> eff(nbins, 0.0);
+
+  double effmax(0.0);
+  for (unsigned bin = 0; bin < nbins; ++bin) {
+    if (_ntried[bin] > 0.0) eff[bin] = _npassed[bin] / _ntried[bin];
+    effmax = std::max(effmax, eff[bin]);
+  }
+  if (not (effmax > 0.0)) {
+    ERROR("No accepted events in the map, cannot build sampler.");
+    return false;
+  }
+
+  _cdf.assign(nbins, 0.0);
+  _weights.assign(nbins, 0.0);
+
+  // sampling density, template and accepted template normalisations
+  double dnorm(0.0), fnorm(0.0), anorm(0.0), snorm(0.0);
+  const double pwidth((_max[0] - _min[0]) / _nbins[0]),
+    etawidth((_max[1] - _min[1]) / _nbins[1]);
+  for (unsigned ip = 0; ip < _nbins[0]; ++ip) {
+    double fp(hmomp->GetBinContent(hmomp->GetXaxis()->
+				   FindFixBin(_min[0] + (ip + 0.5) * pwidth)));
+    for (unsigned ieta = 0; ieta < _nbins[1]; ++ieta) {
+      double feta(hmomn->GetBinContent(hmomn->GetXaxis()->
+				       FindFixBin(_min[1] + (ieta + 0.5) * etawidth)));
+      const unsigned bin(ip * _nbins[1] + ieta);
+      double f(std::max(fp, 0.0) * std::max(feta, 0.0));
+      const double accepted(eff[bin]);
+      eff[bin] = std::max(eff[bin], floor * effmax);
+      fnorm += f;
+      dnorm += f * eff[bin];
+      anorm += f * accepted;
+      snorm += f * eff[bin] * accepted;
+      _cdf[bin] = dnorm;
+    }
+  }
+  if (not (anorm > 0.0)) {
+    ERROR("Templates do not overlap with the accepted region.");
+    return false;
+  }
+
+  // weight = template / sampling density, normalised such that the
+  // mean weight of accepted (not of all sampled) events is 1
+  for (unsigned bin = 0; bin < nbins; ++bin) {
+    _weights[bin] = snorm / (anorm * eff[bin]);
+  }
+
+  DEBUG("Mean efficiency used for sampling: " << dnorm / fnorm);
+  return true;
+}
+
+
+double AcceptanceMap::sample(double &p, double &eta) const
+{
+  double u(gRandom->Rndm() * _cdf.back());
+  unsigned bin(std::upper_bound(_cdf.begin(), _cdf.end(), u) - _cdf.begin());
+  bin = std::min(bin, unsigned(_cdf.size() - 1));
+
+  const unsigned ip(bin / _nbins[1]), ieta(bin % _nbins[1]);
+  p = _min[0] + (ip + gRandom->Rndm()) * (_max[0] - _min[0]) / _nbins[0];
+  eta = _min[1] + (ieta + gRandom->Rndm()) * (_max[1] - _min[1]) / _nbins[1];
+  return _weights[bin];
+}
+
+
+double AcceptanceMap::get_ntried() const
+{
+  double ntried(0.0);
+  for (unsigned bin = 0; bin < _ntried.size(); ++bin) {
+    ntried += _ntried[bin];
+  }
+  return ntried;
+}
+
+
+bool AcceptanceMap::write(TDirectory *dir, std::string name,
+			  std::string title) const
+{
+  TDirectory *olddir(gDirectory);
+  dir->cd();
+
+  TH2D htried((name + "_tried").c_str(), title.c_str(),
+	      _nbins[0], _min[0], _max[0], _nbins[1], _min[1], _max[1]);
+  TH2D hpassed((name + "_passed").c_str(), title.c_str(),
+	       _nbins[0], _min[0], _max[0], _nbins[1], _min[1], _max[1]);
+  for (unsigned ip = 0; ip < _nbins[0]; ++ip) {
+    for (unsigned ieta = 0; ieta < _nbins[1]; ++ieta) {
+      const unsigned bin(ip * _nbins[1] + ieta);
+      htried.SetBinContent(ip + 1, ieta + 1, _ntried[bin]);
+      hpassed.SetBinContent(ip + 1, ieta + 1, _npassed[bin]);
+    }
+  }
+
+  bool status(dir->WriteTObject(&htried, NULL, "Overwrite") > 0 and
+	      dir->WriteTObject(&hpassed, NULL, "Overwrite") > 0);
+  olddir->cd();
+  if (not status) {
+    ERROR("Could not write acceptance map " << name);
+  }
+  return status;
+}
+
+
+AcceptanceMap* AcceptanceMap::read(TDirectory *dir, std::string name,
+				   std::string title)
+{
+  TH2 *htried = dynamic_cast<TH2*>(dir->Get((name + "_tried").c_str()));
+  TH2 *hpassed = dynamic_cast<TH2*>(dir->Get((name + "_passed").c_str()));
+  if (not (htried and hpassed)) return NULL;
+
+  if (title != htried->GetTitle()) {
+    WARNING("Acceptance map " << name << " is for \"" << htried->GetTitle()
+	    << "\", not \"" << title << "\", ignoring.");
+    return NULL;
+  }
+
+  AcceptanceMap *accmap =
+    new AcceptanceMap(htried->GetNbinsX(), htried->GetXaxis()->GetXmin(),
+		      htried->GetXaxis()->GetXmax(), htried->GetNbinsY(),
+		      htried->GetYaxis()->GetXmin(),
+		      htried->GetYaxis()->GetXmax());
+  for (unsigned ip = 0; ip < accmap->_nbins[0]; ++ip) {
+    for (unsigned ieta = 0; ieta < accmap->_nbins[1]; ++ieta) {
+      const unsigned bin(ip * accmap->_nbins[1] + ieta);
+      accmap->_ntried[bin] = htried->GetBinContent(ip + 1, ieta + 1);
+      accmap->_npassed[bin] = hpassed->GetBinContent(ip + 1, ieta + 1);
+    }
+  }
+  return accmap;
+}
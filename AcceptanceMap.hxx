@@ -0,0 +1,244 @@
+/**
+ * @file   AcceptanceMap.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 19 10:31:05 2026
+ *
+ * @brief  Binned acceptance efficiency as a function of mother kinematics
+ *
+ *
+ */
+
+#ifndef ACCEPTANCEMAP_HXX
+#define ACCEPTANCEMAP_HXX
+
+// STL headers
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include <TH1.h>
+#include <TDirectory.h>
+
+
+/**
+ * This class holds the fraction of events inside the detector
+ * acceptance binned in the 3-momentum (p) and pseudorapidity (η) of
+ * the mother particle.
+ *
+ * It also implements importance sampling of the mother kinematics:
+ * the p and η templates are multiplied by the acceptance efficiency
+ * so that mothers are generated preferentially where the daughters
+ * end up inside the acceptance.  Each sampled mother is returned with
+ * a weight correcting for the bias, so weighted distributions remain
+ * unbiased.  For this to be exact the binning of the map has to match
+ * the binning of the templates; use the constructor which takes the
+ * template histograms.  Templates with variable bin widths are not
+ * supported (see check_templates).
+ *
+ * A map can be written to and read back from a ROOT file, so that a
+ * high statistics map for a decay channel is only built once.  Maps
+ * are stored under a name and a title; the title holds the full
+ * description of what the map is valid for (see
+ * TwoBodyDecayGen::get_channel_key), and is checked when reading.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-19 Mon
+ *
+ */
+
+class AcceptanceMap {
+public:
+
+  /**
+   * Constructor with uniform binning
+   *
+   * @param npbins Number of bins in mother momentum
+   * @param pmin Lower edge of the momentum axis in GeV/c
+   * @param pmax Upper edge of the momentum axis in GeV/c
+   * @param netabins Number of bins in mother pseudorapidity
+   * @param etamin Lower edge of the pseudorapidity axis
+   * @param etamax Upper edge of the pseudorapidity axis
+   */
+  AcceptanceMap(unsigned npbins, double pmin, double pmax,
+		unsigned netabins, double etamin, double etamax);
+
+  /**
+   * Constructor with binning taken from the template histograms
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   */
+  AcceptanceMap(TH1 *hmomp, TH1 *hmomn);
+
+  ~AcceptanceMap() {}
+
+  /**
+   * Check that templates can be used with a map
+   *
+   * Maps have uniform bins, and templates are looked up at the map
+   * bin centres, so templates with variable bin widths are rejected.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   *
+   * @return False if a template has variable bin widths
+   */
+  static bool check_templates(TH1 *hmomp, TH1 *hmomn);
+
+  /**
+   * Find the bin for the given mother kinematics
+   *
+   * @param p Mother momentum in GeV/c
+   * @param eta Mother pseudorapidity
+   * @param ip Returns momentum bin index (starting from 0)
+   * @param ieta Returns pseudorapidity bin index (starting from 0)
+   *
+   * @return False if outside the map
+   */
+  bool find_bin(double p, double eta, unsigned &ip, unsigned &ieta) const;
+
+  /**
+   * Record one generated event
+   *
+   * @param p Mother momentum in GeV/c
+   * @param eta Mother pseudorapidity
+   * @param accepted Whether the event passed the acceptance
+   */
+  void fill(double p, double eta, bool accepted);
+
+  /**
+   * Return acceptance efficiency for the given mother kinematics
+   *
+   * @param p Mother momentum in GeV/c
+   * @param eta Mother pseudorapidity
+   *
+   * @return Efficiency (0 if outside the map or bin is empty)
+   */
+  double get_efficiency(double p, double eta) const;
+
+  /**
+   * Return acceptance efficiency integrated over the whole map
+   *
+   * @return Efficiency (0 if empty)
+   */
+  double get_efficiency() const;
+
+  /**
+   * Return acceptance efficiency averaged over the template spectra
+   *
+   * This predicts the fraction of events generated from the templates
+   * that end up inside the acceptance, without generating anything.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   *
+   * @return Efficiency (0 if the map or the templates are empty or not supported)
+   */
+  double get_efficiency(TH1 *hmomp, TH1 *hmomn) const;
+
+  /**
+   * Prepare importance sampling of the mother kinematics
+   *
+   * The sampling density is proportional to template(p) × template(η)
+   * × efficiency(p, η).  Bins where the efficiency is below floor
+   * times the maximum efficiency are sampled as if they had that
+   * efficiency, so poorly populated bins are not excluded entirely.
+   *
+   * The correcting weights are normalised such that the mean weight
+   * of accepted events is 1 (as estimated from the map), rather than
+   * the mean weight of all sampled events.  Weighted accepted events
+   * of a channel then sum up to the number of accepted events, and a
+   * fixed number of accepted events per channel (as generated by
+   * TwoBodyDecayGen::get_event_tree) can be mixed without further
+   * correction.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param floor Minimum efficiency relative to the maximum
+   *
+   * @return Status (false for empty maps or unsupported templates)
+   */
+  bool build_sampler(TH1 *hmomp, TH1 *hmomn, double floor=0.01);
+
+  /**
+   * Sample mother kinematics from the acceptance weighted templates
+   *
+   * build_sampler has to be called first.
+   *
+   * @param p Returns mother momentum in GeV/c
+   * @param eta Returns mother pseudorapidity
+   *
+   * @return Weight correcting for the sampling bias
+   */
+  double sample(double &p, double &eta) const;
+
+  /**
+   * Write map to a ROOT directory
+   *
+   * @param dir Directory (or file) to write to
+   * @param name Name of the map
+   * @param title Description of the map (e.g. decay channel key)
+   *
+   * @return Status
+   */
+  bool write(TDirectory *dir, std::string name, std::string title) const;
+
+  /**
+   * Read map from a ROOT directory
+   *
+   * @param dir Directory (or file) to read from
+   * @param name Name of the map
+   * @param title Expected description of the map
+   *
+   * @return New map (owned by the caller), NULL if not found or the title does not match
+   */
+  static AcceptanceMap* read(TDirectory *dir, std::string name,
+			     std::string title);
+
+  /**
+   * Return number of events the map was filled with
+   *
+   * @return Events inside the map
+   */
+  double get_ntried() const;
+
+  /**
+   * Return number of bins along an axis
+   *
+   * @param axis 0 for momentum, 1 for pseudorapidity
+   *
+   * @return Number of bins
+   */
+  unsigned get_nbins(unsigned axis) const { return _nbins[axis]; }
+
+  /**
+   * Return lower edge of an axis
+   *
+   * @param axis 0 for momentum, 1 for pseudorapidity
+   *
+   * @return Lower edge
+   */
+  double get_min(unsigned axis) const { return _min[axis]; }
+
+  /**
+   * Return upper edge of an axis
+   *
+   * @param axis 0 for momentum, 1 for pseudorapidity
+   *
+   * @return Upper edge
+   */
+  double get_max(unsigned axis) const { return _max[axis]; }
+
+private:
+
+  static unsigned long long _count; /**< Debug message counter */
+  unsigned _nbins[2];		/**< Number of bins in p and η */
+  double _min[2];		/**< Lower edges of the p and η axes */
+  double _max[2];		/**< Upper edges of the p and η axes */
+  std::vector<double> _ntried;	/**< Generated events per bin */
+  std::vector<double> _npassed;	/**< Accepted events per bin */
+  std::vector<double> _cdf;	/**< Cumulative sampling density */
+  std::vector<double> _weights;	/**< Correcting weight per bin */
+};
+
+#endif	// ACCEPTANCEMAP_HXX
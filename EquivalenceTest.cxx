@@ -0,0 +1,470 @@
+/**
+ * @file   EquivalenceTest.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 27 11:52:40 2026
+ *
+ * @brief  Implementation of EquivalenceTest
+ *
+ *
+ */
+
+// STL headers
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <deque>
+
+/**
+ * \def _USE_MATH_DEFINES
+ * Enable definitions from cmath (e.g. mathematical constants)
+ */
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+// Boost headers
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+// ROOT headers
+#include <TH1D.h>
+#include <TMath.h>
+#include <TRandom3.h>
+#include <TThread.h>
+#include <TLorentzVector.h>
+
+// package headers
+#include "EquivalenceTest.hxx"
+#include "RootAdapter.hxx"
+#include "WallClock.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long EquivalenceTest::_count(0);
+
+
+EquivalenceTest::EquivalenceTest(double *masses, unsigned nparts, TH1 *hmomp,
+				 TH1 *hmomn) :
+  _reference(masses, nparts), _core(masses, nparts), _coreengine(_core),
+  _candidate(&_coreengine), _hmomp(hmomp), _hmomn(hmomn), _alpha(0.01),
+  _full_accept(false), _early_reject(false)
+{
+  _walltime[0] = _walltime[1] = 0.0;
+}
+
+
+EquivalenceTest::~EquivalenceTest()
+{
+  _clear();
+}
+
+
+bool EquivalenceTest::add_decay_channel(double *masses, unsigned nparts,
+					double brfr)
+{
+  return _reference.add_decay_channel(masses, nparts, brfr) and
+    _core.add_decay_channel(masses, nparts, brfr);
+}
+
+
+void EquivalenceTest::set_candidate(DecayEngine *candidate)
+{
+  _candidate = candidate ? candidate : &_coreengine;
+  return;
+}
+
+
+void EquivalenceTest::set_full_acceptance(bool full)
+{
+  _reference.set_full_acceptance(full);
+  _full_accept = full;
+  return;
+}
+
+
+void EquivalenceTest::set_early_rejection(bool early)
+{
+  _reference.set_early_rejection(early);
+  _early_reject = early;
+  return;
+}
+
+
+void EquivalenceTest::_clear()
+{
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    Channel *channel(_channels[c]);
+    for (unsigned k = 0; k < channel->entries.size(); ++k) {
+      delete channel->entries[k].observable;
+    }
+    for (unsigned s = 0; s < 2; ++s) {
+      for (unsigned k = 0; k < channel->samples[s].hists.size(); ++k) {
+	delete channel->samples[s].hists[k];
+      }
+    }
+    delete channel;
+  }
+  _channels.clear();
+  _skipped.clear();
+  return;
+}
+
+
+void EquivalenceTest::_book()
+{
+  _clear();
+
+  std::vector<std::deque<TwoBodyDecayGen::chBFpair> > brfrVec;
+  std::deque<TwoBodyDecayGen::chBFpair> brfrQ;
+  _reference.find_leaf_nodes(brfrVec, brfrQ);
+
+  // leaf branches and candidate channels are in the same order,
+  // branches that do not decay the whole tree have no channel
+  unsigned chid(0);
+  for (unsigned leaf = 0; leaf < brfrVec.size(); ++leaf) {
+    unsigned nparticles(_reference.get_nparticles(brfrVec[leaf]));
+    if (chid >= _candidate->get_nchannels() or
+	nparticles != _candidate->get_nparticles(chid)) {
+      std::ostringstream note;
+      note << "leaf branch " << leaf << " (" << nparticles << " particles)";
+      _skipped.push_back(note.str());
+      continue;
+    }
+
+    Channel *channel = new Channel;
+    channel->chQ = brfrVec[leaf];
+    channel->chid = chid++;
+    if (brfrVec.size() > 1) {
+      std::ostringstream name;
+      name << "ch" << channel->chid << " ";
+      channel->name = name.str();
+    }
+    _channels.push_back(channel);
+  }
+  if (chid < _candidate->get_nchannels()) {
+    ERROR("Candidate has " << _candidate->get_nchannels() << " channels, only "
+	  << chid << " match a leaf branch of the reference.");
+  }
+
+  const double pmax(_hmomp->GetXaxis()->GetXmax());
+  const double etarange[2] = {_hmomn->GetXaxis()->GetXmin() - 3.0,
+			      _hmomn->GetXaxis()->GetXmax() + 3.0};
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    Channel &channel(*_channels[c]);
+    std::vector<Entry> &entries(channel.entries);
+    const std::vector<DecayGenCore::Vertex>
+      &vertices(_core.get_channel(channel.chid).vertices);
+
+    // momentum and η of every particle
+    for (unsigned i = 1; i < _candidate->get_nparticles(channel.chid); ++i) {
+      std::ostringstream name;
+      name << channel.name << "p[" << i << "]";
+      Entry pentry = {name.str(), new MomentumObservable(i), 100, {0.0, pmax}};
+      entries.push_back(pentry);
+      name.str("");
+      name << channel.name << "eta[" << i << "]";
+      Entry etaentry = {name.str(), new PseudorapidityObservable(i), 100,
+			{etarange[0], etarange[1]}};
+      entries.push_back(etaentry);
+    }
+
+    // helicity angle of every vertex, and final-state particles
+    std::vector<unsigned> finalstate;
+    for (unsigned i = 0; i < vertices.size(); ++i) {
+      std::ostringstream name;
+      name << channel.name << "cos(theta)[" << NDAUS*i + 1 << "]";
+      Entry entry = {name.str(), new HelicityObservable(NDAUS*i + 1,
+							vertices[i].mother),
+		     50, {-1.0, 1.0}};
+      entries.push_back(entry);
+      for (unsigned j = 0; j < NDAUS; ++j) {
+	if (not vertices[i].decays[j]) finalstate.push_back(NDAUS*i + j + 1);
+      }
+    }
+
+    // invariant mass of final-state pairs (siblings always have the
+    // mass of their mother)
+    for (unsigned a = 0; a < finalstate.size(); ++a) {
+      for (unsigned b = a + 1; b < finalstate.size(); ++b) {
+	if ((finalstate[a] - 1) / NDAUS == (finalstate[b] - 1) / NDAUS) {
+	  continue;
+	}
+	std::ostringstream name;
+	name << channel.name << "m[" << finalstate[a] << "," << finalstate[b]
+	     << "]";
+	Entry entry = {name.str(), new MassObservable(finalstate[a],
+						      finalstate[b]),
+		       100, {0.0, _core.get_mass()}};
+	entries.push_back(entry);
+      }
+    }
+
+    // histograms are created here, ROOT object creation is not thread safe
+    const char *engines[2] = {"reference", "candidate"};
+    for (unsigned s = 0; s < 2; ++s) {
+      for (unsigned k = 0; k < entries.size(); ++k) {
+	std::ostringstream hname;
+	hname << "equivalence_" << engines[s] << "_" << c << "_" << k;
+	TH1 *hist = new TH1D(hname.str().c_str(), entries[k].name.c_str(),
+			     entries[k].nbins, entries[k].range[0],
+			     entries[k].range[1]);
+	hist->SetDirectory(NULL);
+	channel.samples[s].hists.push_back(hist);
+      }
+      channel.samples[s].ntried = channel.samples[s].naccepted = 0;
+    }
+  }
+  return;
+}
+
+
+void EquivalenceTest::_fill(const Channel &channel, Sample &sample,
+			    const double *particles) const
+{
+  for (unsigned k = 0; k < channel.entries.size(); ++k) {
+    sample.hists[k]->Fill((*channel.entries[k].observable)(particles));
+  }
+  return;
+}
+
+
+void EquivalenceTest::_run_reference(unsigned long nevents)
+{
+  double start(walltime());
+
+  const bool full(_full_accept), early(_early_reject);
+  const double mommass(_core.get_mass());
+  std::vector<TLorentzVector> particle_lvs;
+  std::vector<double> particles;
+  TLorentzVector momp;
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    Channel &channel(*_channels[c]);
+    Sample &sample(channel.samples[0]);
+    for (unsigned long evt = 0; evt < nevents; ++evt) {
+      // same as get_event_tree
+      double eta(_hmomn->GetRandom());
+      double pt(_hmomp->GetRandom() / std::cosh(eta));
+      double phi(2 * M_PI * gRandom->Rndm());
+      momp.SetPtEtaPhiM(pt, eta, phi, mommass);
+
+      particle_lvs.clear();
+      particle_lvs.push_back(momp);
+      if (not (_reference.generate(momp, particle_lvs, channel.chQ, full,
+				   early) > 0)) {
+	continue;
+      }
+
+      particles.resize(4 * particle_lvs.size());
+      for (unsigned i = 0; i < particle_lvs.size(); ++i) {
+	particles[4*i] = particle_lvs[i].Px();
+	particles[4*i + 1] = particle_lvs[i].Py();
+	particles[4*i + 2] = particle_lvs[i].Pz();
+	particles[4*i + 3] = particle_lvs[i].E();
+      }
+      _fill(channel, sample, &particles[0]);
+      sample.naccepted++;
+    }
+    sample.ntried = nevents;
+  }
+
+  _walltime[0] = walltime() - start;
+  return;
+}
+
+
+void EquivalenceTest::_run_candidate(unsigned long nevents, unsigned seed,
+				     const TemplateSampler *psampler,
+				     const TemplateSampler *etasampler)
+{
+  double start(walltime());
+
+  _candidate->set_seed(seed);
+
+  std::vector<double> particles;
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    Channel &channel(*_channels[c]);
+    Sample &sample(channel.samples[1]);
+    particles.assign(4 * _candidate->get_nparticles(channel.chid), 0.0);
+    for (unsigned long evt = 0; evt < nevents; ++evt) {
+      if (not _candidate->sample_mother(*psampler, etasampler,
+					&particles[0])) {
+	continue;
+      }
+      if (not (_candidate->generate(channel.chid, &particles[0]) > 0)) {
+	continue;
+      }
+      _fill(channel, sample, &particles[0]);
+      sample.naccepted++;
+    }
+    sample.ntried = nevents;
+  }
+
+  _walltime[1] = walltime() - start;
+  return;
+}
+
+
+bool EquivalenceTest::run(unsigned long nevents, unsigned seed)
+{
+  _book();
+  _candidate->set_full_acceptance(_full_accept);
+  _candidate->set_early_rejection(_early_reject);
+
+  // TGenPhaseSpace and TH1::GetRandom use gRandom, only the reference
+  // thread touches it; templates are converted before starting
+  TThread::Initialize();
+  gRandom = new TRandom3(seed + 1);
+  _hmomp->ComputeIntegral();
+  _hmomn->ComputeIntegral();
+  TemplateSampler psampler(RootAdapter::make_sampler(_hmomp)),
+    etasampler(RootAdapter::make_sampler(_hmomn));
+
+  boost::thread_group threads;
+  threads.create_thread(boost::bind(&EquivalenceTest::_run_reference, this,
+				    nevents));
+  threads.create_thread(boost::bind(&EquivalenceTest::_run_candidate, this,
+				    nevents, seed, &psampler, &etasampler));
+  threads.join_all();
+
+  // a candidate channel without a leaf branch fails the test
+  _results.clear();
+  unsigned ntests(0);
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    ntests += 2 * _channels[c]->entries.size() + 1;
+  }
+  bool verdict(_channels.size() == _candidate->get_nchannels());
+  if (not verdict) {
+    Result result = {"channels", 0.0, -1.0, false};
+    _results.push_back(result);
+  }
+  const double threshold(_alpha / std::max(ntests, 1u));
+
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    const Channel &channel(*_channels[c]);
+    const Sample &ref(channel.samples[0]), &cand(channel.samples[1]);
+
+    // acceptance efficiency, two-sample binomial test
+    double eff[2] = {double(ref.naccepted) / std::max(ref.ntried, 1UL),
+		     double(cand.naccepted) / std::max(cand.ntried, 1UL)};
+    double pooled(double(ref.naccepted + cand.naccepted) /
+		  std::max(ref.ntried + cand.ntried, 1UL));
+    double sigma(std::sqrt(pooled * (1 - pooled) *
+			   (1.0 / std::max(ref.ntried, 1UL) +
+			    1.0 / std::max(cand.ntried, 1UL))));
+    double prob(sigma > 0 ? TMath::Erfc(std::fabs(eff[0] - eff[1]) /
+					sigma / M_SQRT2) :
+		(eff[0] == eff[1] ? 1.0 : 0.0));
+    Result effresult = {channel.name + "efficiency", prob, -1.0,
+			prob > threshold};
+    _results.push_back(effresult);
+    verdict = verdict and effresult.pass;
+
+    for (unsigned k = 0; k < channel.entries.size(); ++k) {
+      TH1 *href(ref.hists[k]), *hcand(cand.hists[k]);
+      Result result = {channel.entries[k].name, 1.0, 1.0, true};
+      if (href->GetEntries() > 0 or hcand->GetEntries() > 0) {
+	result.chi2prob = href->Chi2Test(hcand, "UU");
+	result.ksprob = href->KolmogorovTest(hcand);
+      }
+      result.pass = result.chi2prob > threshold and result.ksprob > threshold;
+      verdict = verdict and result.pass;
+      _results.push_back(result);
+    }
+  }
+
+  DEBUG("Compared " << _results.size() << " quantities in "
+	<< _channels.size() << " channel(s), threshold " << threshold);
+  return verdict;
+}
+
+
+double EquivalenceTest::get_speedup() const
+{
+  return _walltime[1] > 0 ? _walltime[0] / _walltime[1] : 0.0;
+}
+
+
+void EquivalenceTest::print(bool verbose) const
+{
+  unsigned nfailed(0);
+  for (unsigned k = 0; k < _results.size(); ++k) {
+    const Result &result(_results[k]);
+    if (not result.pass) nfailed++;
+    if (not (verbose or not result.pass)) continue;
+    std::cout << std::setw(20) << std::left << result.name
+	      << std::setw(14) << std::right << std::setprecision(4)
+	      << result.chi2prob << std::setw(14);
+    if (result.ksprob < 0) {
+      std::cout << "-";
+    } else {
+      std::cout << result.ksprob;
+    }
+    std::cout << (result.pass ? "" : "  FAILED") << std::endl;
+  }
+
+  for (unsigned c = 0; c < _channels.size(); ++c) {
+    const Channel &channel(*_channels[c]);
+    std::cout << channel.name << "Efficiency: " << std::setprecision(4)
+	      << double(channel.samples[0].naccepted) /
+		 std::max(channel.samples[0].ntried, 1UL) << " (reference), "
+	      << double(channel.samples[1].naccepted) /
+		 std::max(channel.samples[1].ntried, 1UL) << " (candidate)"
+	      << std::endl;
+  }
+  for (unsigned i = 0; i < _skipped.size(); ++i) {
+    std::cout << "Not compared, does not decay the whole tree: "
+	      << _skipped[i] << std::endl;
+  }
+  std::cout << "Wall time: " << _walltime[0] << " s (reference), "
+	    << _walltime[1] << " s (candidate), speed-up: "
+	    << get_speedup() << std::endl;
+  std::cout << (nfailed ? "FAIL" : "PASS") << ": " << nfailed << " of "
+	    << _results.size() << " comparisons failed at significance "
+	    << _alpha << std::endl;
+  return;
+}
+
+
+/**
+ * Make a random subtree, in the particle mass array format
+ *
+ * The daughter arrays are interleaved so that
+ * DecayGenCore::split_daughter_trees splits them again.
+ *
+ * @param depth Number of decay levels (0 for a final-state particle)
+ * @param rng Random number generator
+ *
+ * @return Particle masses
+ */
+static std::vector<double> random_subtree(unsigned depth, TRandom &rng)
+{
+  static const double finalstate[6] = {0.0, 0.000511, 0.10566, 0.13957,
+				       0.49368, 0.93827};
+  std::vector<double> masses;
+  if (depth == 0) {
+    masses.push_back(finalstate[rng.Integer(6)]);
+    return masses;
+  }
+
+  std::vector<double> dau1(random_subtree(depth - 1, rng)),
+    dau2(random_subtree(depth - 1, rng));
+  masses.push_back(dau1[0] + dau2[0] + rng.Uniform(0.05, 1.0));
+  masses.push_back(dau1[0]);
+  masses.push_back(dau2[0]);
+  // daughters of node i are 2i + 1 and 2i + 2, nodes alternate
+  // between the first and the second daughter tree
+  for (unsigned i = 1; i < dau1.size(); ++i) {
+    const std::vector<double> &dau(i % 2 ? dau1 : dau2);
+    unsigned k(i % 2 ? i : i - 1);
+    masses.push_back(dau[k]);
+    masses.push_back(dau[k + 1]);
+  }
+  return masses;
+}
+
+
+std::vector<double> EquivalenceTest::random_cascade(unsigned depth,
+						    unsigned seed)
+{
+  TRandom3 rng(seed);
+  return random_subtree(std::max(depth, 1u), rng);
+}
@@ -0,0 +1,264 @@
+/**
+ * @file   EquivalenceTest.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 27 10:14:22 2026
+ *
+ * @brief  Statistical comparison of the reference and core generators
+ *
+ *
+ */
+
+#ifndef EQUIVALENCETEST_HXX
+#define EQUIVALENCETEST_HXX
+
+// STL headers
+#include <string>
+#include <vector>
+#include <deque>
+
+// Boost headers
+#include <boost/noncopyable.hpp>
+
+// ROOT headers
+#include <TH1.h>
+
+// package headers
+#include "TwoBodyDecayGen.hxx"
+#include "DecayGenCore.hxx"
+#include "DecayEngine.hxx"
+#include "Observables.hxx"
+
+
+/**
+ * This class checks that a candidate generator reproduces the
+ * reference generator (TwoBodyDecayGen::generate on top of
+ * TGenPhaseSpace) for one decay tree.
+ *
+ * The candidate is any DecayEngine, by default DecayGenCore built
+ * from the same particle mass arrays.  Every leaf branch of
+ * TwoBodyDecayGen::find_leaf_nodes is compared with the candidate
+ * channel that has the same number of particles, in order.  Branches
+ * that do not decay the whole tree (see DecayGenCore) have no
+ * candidate channel; they are listed, but not compared.
+ *
+ * Both generators generate the same number of events per channel
+ * from the same mother templates, each on its own thread.  Every
+ * accepted event fills, in a single pass, histograms of the momentum
+ * and pseudorapidity of all particles, the helicity angle of the
+ * first daughter of every vertex, and the invariant mass of every
+ * pair of final-state particles from different vertices.  The
+ * histograms of the two generators are compared with χ² and
+ * Kolmogorov-Smirnov tests, and the acceptance efficiencies with a
+ * binomial test.  A comparison fails if a p-value is below the
+ * significance level divided by the number of comparisons.
+ *
+ * The wall time of each generator is measured as well, so a faster
+ * candidate can be adopted once it passes.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-27 Tue
+ *
+ */
+
+class EquivalenceTest : private boost::noncopyable {
+public:
+
+  /**
+   * Outcome of one comparison
+   */
+  struct Result {
+    std::string name;		/**< Compared quantity */
+    double chi2prob;		/**< χ² test p-value */
+    double ksprob;		/**< Kolmogorov-Smirnov test p-value */
+    bool pass;			/**< Compatible */
+  };
+
+  /**
+   * Constructor
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   */
+  EquivalenceTest(double *masses, unsigned nparts, TH1 *hmomp, TH1 *hmomn);
+
+  ~EquivalenceTest();
+
+  /**
+   * Add a new decay channel to the reference and the default candidate
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   * @param brfr Branching fraction for the channel
+   *
+   * @return Status
+   */
+  bool add_decay_channel(double *masses, unsigned nparts, double brfr);
+
+  /**
+   * Use another candidate generator
+   *
+   * It has to be built from the same particle mass arrays, with the
+   * same decay channels.  The acceptance options are set on it when
+   * the test runs.
+   *
+   * @param candidate Candidate (not owned), NULL for DecayGenCore
+   */
+  void set_candidate(DecayEngine *candidate);
+
+  /**
+   * Use the full acceptance definition in both generators
+   *
+   * @param full Require all final-state particles in acceptance
+   */
+  void set_full_acceptance(bool full=true);
+
+  /**
+   * Use early rejection in both generators
+   *
+   * @param early Use early rejection
+   */
+  void set_early_rejection(bool early=true);
+
+  /**
+   * Set significance level of the whole test
+   *
+   * @param alpha Significance level (default 0.01)
+   */
+  void set_significance(double alpha) { _alpha = alpha; }
+
+  /**
+   * Run both generators and compare
+   *
+   * @param nevents Number of events tried by each generator per channel
+   * @param seed Seed (the reference uses seed + 1)
+   *
+   * @return Verdict (true if all comparisons pass)
+   */
+  bool run(unsigned long nevents, unsigned seed=4357);
+
+  /**
+   * Return results of the last run
+   *
+   * @return Results, one per compared quantity
+   */
+  const std::vector<Result>& get_results() const { return _results; }
+
+  /**
+   * Return speed-up of the candidate over the reference
+   *
+   * @return Ratio of the reference to the candidate wall time
+   */
+  double get_speedup() const;
+
+  /**
+   * Print results, failures only unless verbose
+   *
+   * @param verbose Print all comparisons
+   */
+  void print(bool verbose=false) const;
+
+  /**
+   * Make a random decay cascade
+   *
+   * All decay vertices down to the given depth are filled (a complete
+   * binary tree), with final-state particles chosen among γ, e, μ, π,
+   * K and p, and every resonance 50 MeV/c² to 1 GeV/c² above its
+   * threshold.
+   *
+   * @param depth Number of decay levels (≥ 1)
+   * @param seed Seed
+   *
+   * @return Particle mass array, as taken by the TwoBodyDecayGen constructor
+   */
+  static std::vector<double> random_cascade(unsigned depth, unsigned seed);
+
+private:
+
+  /**
+   * Histograms and counters of one generator
+   */
+  struct Sample {
+    std::vector<TH1*> hists;	/**< One histogram per observable */
+    unsigned long ntried;	/**< Tried events */
+    unsigned long naccepted;	/**< Accepted events */
+  };
+
+  /**
+   * Observable with its histogram binning
+   */
+  struct Entry {
+    std::string name;		/**< Name */
+    Observable *observable;	/**< Observable (owned) */
+    unsigned nbins;		/**< Number of bins */
+    double range[2];		/**< Histogram range */
+  };
+
+  /**
+   * Leaf branch compared with a candidate channel
+   */
+  struct Channel {
+    std::string name;		/**< Prefix of the result names */
+    std::deque<TwoBodyDecayGen::chBFpair> chQ; /**< Reference leaf branch */
+    unsigned chid;		/**< Candidate channel id */
+    std::vector<Entry> entries;	/**< Compared observables */
+    Sample samples[2];		/**< Reference and candidate */
+  };
+
+  /**
+   * Match leaf branches to candidate channels, and book histograms
+   */
+  void _book();
+
+  /**
+   * Delete observables and histograms
+   */
+  void _clear();
+
+  /**
+   * Fill histograms of an accepted event
+   *
+   * @param channel Compared channel
+   * @param sample Histograms
+   * @param particles 4-momenta of all particles
+   */
+  void _fill(const Channel &channel, Sample &sample,
+	     const double *particles) const;
+
+  /**
+   * Generate with the reference generator
+   *
+   * @param nevents Number of tried events per channel
+   */
+  void _run_reference(unsigned long nevents);
+
+  /**
+   * Generate with the candidate generator
+   *
+   * @param nevents Number of tried events per channel
+   * @param seed Seed
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   */
+  void _run_candidate(unsigned long nevents, unsigned seed,
+		      const TemplateSampler *psampler,
+		      const TemplateSampler *etasampler);
+
+  static unsigned long long _count; /**< Debug message counter */
+  TwoBodyDecayGen _reference;	/**< Reference generator */
+  DecayGenCore _core;		/**< Default candidate, and vertex layout */
+  CoreEngine _coreengine;	/**< Default candidate as an engine */
+  DecayEngine *_candidate;	/**< Candidate generator */
+  TH1 *_hmomp;			/**< Mother momentum template */
+  TH1 *_hmomn;			/**< Mother η template */
+  double _alpha;		/**< Significance level */
+  bool _full_accept;		/**< Full acceptance definition */
+  bool _early_reject;		/**< Early rejection */
+  std::vector<Channel*> _channels; /**< Compared channels */
+  std::vector<std::string> _skipped; /**< Leaf branches not compared */
+  double _walltime[2];		/**< Reference and candidate wall time */
+  std::vector<Result> _results;	/**< Results of the last run */
+};
+
+#endif	// EQUIVALENCETEST_HXX
@@ -0,0 +1,117 @@
+/**
+ * @file   EventStream.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 28 11:21:36 2026
+ *
+ * @brief  Implementation of EventStream
+ *
+ *
+ */
+
+// STL headers
+#include <algorithm>
+
+// Boost headers
+#include <boost/foreach.hpp>
+
+// ROOT headers
+#include <TRandom.h>
+
+// package headers
+#include "EventStream.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long EventStream::_count(0);
+
+
+EventStream::EventStream(TwoBodyDecayGen &generator, TH1 *hmomp, TH1 *hmomn,
+			 unsigned long nevents, unsigned long maxtries) :
+  _generator(generator), _hmomp(hmomp), _hmomn(hmomn), _nevents(nevents),
+  _maxtries(maxtries), _ended(false), _ntried(0), _naccepted(0)
+{
+  std::deque<chBFpair> brfrQ;
+  _generator.find_leaf_nodes(_brfrVec, brfrQ);
+
+  // cumulative effective BF, to pick a channel per event
+  BOOST_FOREACH(std::deque<chBFpair> chQ, _brfrVec) {
+    double eff_brfr(1.0);
+    BOOST_FOREACH(chBFpair ch, chQ) {
+      eff_brfr *= ch.second;
+    }
+    _cumbrfr.push_back((_cumbrfr.empty() ? 0.0 : _cumbrfr.back()) + eff_brfr);
+  }
+  if (_cumbrfr.empty() or not (_cumbrfr.back() > 0.0)) {
+    ERROR("Branching fractions sum to 0, no events can be generated");
+    _ended = true;
+  }
+  _nparticles = _generator.get_nparticles();
+
+  _event.particle_lvs.reserve(_nparticles);
+  _event.evt_wt = 0.0;
+  _event.chid = 0;
+  _scratch = _event;
+}
+
+
+bool EventStream::_generate(Event &event)
+{
+  if (_ended or (_nevents > 0 and _naccepted >= _nevents)) return false;
+
+  TLorentzVector momp;
+  for (unsigned long ntries = 0; ; ++ntries) {
+    if (ntries == _maxtries) {
+      ERROR("No event accepted in " << _maxtries << " tries, ending stream");
+      _ended = true;
+      return false;
+    }
+    _ntried++;
+    if (not _generator.sample_mother(_hmomp, _hmomn, momp)) continue;
+
+    unsigned ich(std::upper_bound(_cumbrfr.begin(), _cumbrfr.end(),
+				  gRandom->Rndm() * _cumbrfr.back())
+		 - _cumbrfr.begin());
+    event.chid = std::min(ich, unsigned(_cumbrfr.size() - 1));
+
+    event.particle_lvs.clear();
+    event.particle_lvs.push_back(momp);
+    event.evt_wt = _generator.generate(momp, event.particle_lvs,
+				       _brfrVec[event.chid],
+				       _generator.get_full_acceptance(),
+				       _generator.get_early_rejection());
+    if (event.evt_wt > 0) break;
+  }
+
+  _naccepted++;
+  return true;
+}
+
+
+bool EventStream::next()
+{
+  return _generate(_event);
+}
+
+
+unsigned EventStream::next(unsigned nmax, double *particles, double *weights,
+			   unsigned *channels)
+{
+  unsigned evt(0);
+  for (; evt < nmax and _generate(_scratch); ++evt) {
+    double *out(particles + 4 * _nparticles * evt);
+    const std::vector<TLorentzVector> &lvs(_scratch.particle_lvs);
+    for (unsigned i = 0; i < _nparticles; ++i) {
+      if (i < lvs.size()) {
+	out[4*i] = lvs[i].Px();
+	out[4*i + 1] = lvs[i].Py();
+	out[4*i + 2] = lvs[i].Pz();
+	out[4*i + 3] = lvs[i].E();
+      } else {
+	out[4*i] = out[4*i + 1] = out[4*i + 2] = out[4*i + 3] = 0.0;
+      }
+    }
+    weights[evt] = _scratch.evt_wt;
+    if (channels) channels[evt] = _scratch.chid;
+  }
+  return evt;
+}
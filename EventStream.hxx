@@ -0,0 +1,238 @@
+/**
+ * @file   EventStream.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 28 10:05:17 2026
+ *
+ * @brief  Lazy, pull-based generation of events
+ *
+ *
+ */
+
+#ifndef EVENTSTREAM_HXX
+#define EVENTSTREAM_HXX
+
+// STL headers
+#include <vector>
+#include <deque>
+#include <iterator>
+
+// Boost headers
+#include <boost/noncopyable.hpp>
+
+// ROOT headers
+#include <TH1.h>
+#include <TLorentzVector.h>
+
+// package headers
+#include "TwoBodyDecayGen.hxx"
+
+
+/**
+ * This class generates events of a TwoBodyDecayGen decay tree one at
+ * a time, when they are asked for.
+ *
+ * Unlike get_event_tree, nothing is generated in advance and nothing
+ * is stored: each call to next generates accepted events into the
+ * stream's current event or into the caller's buffers, so a consumer
+ * can stop at any time, or interleave generation with its own
+ * processing.  The stream can also be used as an input range:
+ *
+ *   EventStream stream(generator, &hmomp, &hmomn, 1000);
+ *   for (EventStream::iterator it = stream.begin(); it != stream.end(); ++it) {
+ *     fit.add(it->particle_lvs, it->evt_wt);
+ *   }
+ *
+ * The decay channel of every event is chosen randomly according to
+ * the branching fractions (like DecayGenCore::generate_batch), so
+ * events of different channels are mixed, and only accepted events
+ * are returned.  Mother kinematics are sampled from the templates with
+ * TwoBodyDecayGen::sample_mother, using gRandom.
+ *
+ * A stream ends early (with an error) if the branching fractions of
+ * the tree sum to 0, or if no event is accepted within maxtries
+ * tries, e.g. when the templates lie outside the acceptance.
+ *
+ * None of the programs in this package use EventStream (generator
+ * and histgen fill whole samples); it is meant for consumers that
+ * pull events, like toy fits.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-28 Wed
+ *
+ */
+
+class EventStream : private boost::noncopyable {
+public:
+
+  /**
+   * Generated event
+   */
+  struct Event {
+    std::vector<TLorentzVector> particle_lvs; /**< 4-momenta, as in the event tree */
+    double evt_wt;		/**< Event weight */
+    unsigned chid;		/**< Leaf channel index (as in find_leaf_nodes) */
+  };
+
+  /**
+   * Input iterator, generates the next event when incremented
+   *
+   * All iterators of a stream share its current event.
+   */
+  class iterator {
+  public:
+
+    typedef std::input_iterator_tag iterator_category; /**< Single pass */
+    typedef Event value_type;	/**< Event */
+    typedef std::ptrdiff_t difference_type; /**< Unused */
+    typedef const Event* pointer; /**< Pointer to event */
+    typedef const Event& reference; /**< Reference to event */
+
+    /**
+     * Constructor
+     *
+     * @param stream Event stream (NULL for the end)
+     */
+    iterator(EventStream *stream=NULL) : _stream(stream) {}
+
+    const Event& operator*() const { return _stream->get_event(); }
+    const Event* operator->() const { return &_stream->get_event(); }
+
+    iterator& operator++()
+    {
+      if (not _stream->next()) _stream = NULL;
+      return *this;
+    }
+
+    bool operator==(const iterator &other) const
+    {
+      return _stream == other._stream;
+    }
+
+    bool operator!=(const iterator &other) const
+    {
+      return _stream != other._stream;
+    }
+
+  private:
+
+    EventStream *_stream;	/**< Event stream, NULL at the end */
+  };
+
+  /**
+   * Constructor
+   *
+   * The generator and templates are not copied and have to outlive
+   * the stream.
+   *
+   * @param generator Decay tree
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param nevents Number of accepted events (0 for no limit)
+   * @param maxtries Maximum tried events per accepted event
+   */
+  EventStream(TwoBodyDecayGen &generator, TH1 *hmomp, TH1 *hmomn=NULL,
+	      unsigned long nevents=0, unsigned long maxtries=1000000);
+
+  ~EventStream() {}
+
+  /**
+   * Generate the next accepted event
+   *
+   * @return False if the stream has ended
+   */
+  bool next();
+
+  /**
+   * Generate the next accepted events into caller owned buffers
+   *
+   * Buffers are C arrays: particles[nmax][nparticles][4],
+   * weights[nmax] and channels[nmax], with nparticles from
+   * get_nparticles().  Event i starts at particles[4 * nparticles *
+   * i], and holds the 4-momenta (px, py, pz, E) of particle_lvs in
+   * order, the mother first.  Unused particles of smaller channels
+   * are set to 0.  The current event is not changed.
+   *
+   * @param nmax Maximum number of events (size of the buffers)
+   * @param particles Returns 4-momenta of all particles
+   * @param weights Returns event weights
+   * @param channels Returns leaf channel index, optional
+   *
+   * @return Number of events (less than nmax only if the stream ended)
+   */
+  unsigned next(unsigned nmax, double *particles, double *weights,
+		unsigned *channels=NULL);
+
+  /**
+   * Return the current event (from the last call to next())
+   *
+   * @return Event
+   */
+  const Event& get_event() const { return _event; }
+
+  /**
+   * Return an iterator at the next event
+   *
+   * @return Iterator (end() if the stream is exhausted)
+   */
+  iterator begin() { return next() ? iterator(this) : end(); }
+
+  /**
+   * Return the end iterator
+   *
+   * @return Iterator
+   */
+  iterator end() { return iterator(); }
+
+  /**
+   * Return number of particles in the largest decay channel
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles() const { return _nparticles; }
+
+  /**
+   * Return number of tried events
+   *
+   * @return Tried events
+   */
+  unsigned long get_ntried() const { return _ntried; }
+
+  /**
+   * Return number of accepted events returned so far
+   *
+   * @return Accepted events
+   */
+  unsigned long get_naccepted() const { return _naccepted; }
+
+private:
+
+  /**
+   * Generate events until one is accepted
+   *
+   * Gives up, and ends the stream, after maxtries tried events.
+   *
+   * @param event Returns the event
+   *
+   * @return False if the stream has ended
+   */
+  bool _generate(Event &event);
+
+  typedef TwoBodyDecayGen::chBFpair chBFpair; /**< Channel id and B.F. pair */
+
+  TwoBodyDecayGen &_generator;	/**< Decay tree */
+  TH1 *_hmomp;			/**< Mother momentum template */
+  TH1 *_hmomn;			/**< Mother η template */
+  unsigned long _nevents;	/**< Requested accepted events (0: no limit) */
+  unsigned long _maxtries;	/**< Maximum tries per accepted event */
+  bool _ended;			/**< Stream ended early */
+  unsigned long _ntried;	/**< Tried events */
+  unsigned long _naccepted;	/**< Returned accepted events */
+  std::vector<std::deque<chBFpair> > _brfrVec; /**< Leaf branches */
+  std::vector<double> _cumbrfr;	/**< Cumulative effective BF */
+  unsigned _nparticles;		/**< Particles in the largest channel */
+  Event _event;			/**< Current event */
+  Event _scratch;		/**< Event buffer for batches */
+  static unsigned long long _count; /**< Debug message counter */
+};
+
+#endif	// EVENTSTREAM_HXX
@@ -0,0 +1,178 @@
+/**
+ * @file   HistogramGen.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 12:05:38 2026
+ *
+ * @brief  Fill histograms of observables without storing events
+ *
+ *
+ */
+
+// STL headers
+#include <iostream>
+#include <sstream>
+
+// Boost headers
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+// package headers
+#include "HistogramGen.hxx"
+#include "RootAdapter.hxx"
+#include "ChannelScheduler.hxx"
+#include "WallClock.hxx"
+
+
+/**
+ * Per thread generator and histograms
+ */
+struct HistogramGen::Worker {
+  DecayGenCore generator;		/**< Copy of the generator */
+  const TemplateSampler *psampler;	/**< Template for mother momentum */
+  const TemplateSampler *etasampler;	/**< Template for mother η */
+  const std::vector<HistDef> *defs;	/**< Registered histograms */
+  std::vector<TH1*> hists;		/**< Thread local histograms */
+  ChannelScheduler *scheduler;		/**< Source of events to generate */
+  unsigned id;				/**< Worker id for the scheduler */
+  unsigned seed;			/**< Seed of the first chunk */
+
+  Worker(const DecayGenCore &gen) :
+    generator(gen), psampler(NULL), etasampler(NULL), defs(NULL),
+    scheduler(NULL), id(0), seed(0) {}
+};
+
+
+HistogramGen::HistogramGen(const DecayGenCore &generator) :
+  _generator(generator), _chunksize(1000)
+{}
+
+
+void HistogramGen::set_chunk_size(unsigned long chunksize)
+{
+  _chunksize = chunksize;
+  return;
+}
+
+
+void HistogramGen::add_histogram(TH1 *hist, const Observable *obs)
+{
+  HistDef def = {hist, obs, NULL};
+  _hists.push_back(def);
+  return;
+}
+
+
+void HistogramGen::add_histogram(TH2 *hist, const Observable *xobs,
+				 const Observable *yobs)
+{
+  HistDef def = {hist, xobs, yobs};
+  _hists.push_back(def);
+  return;
+}
+
+
+unsigned long HistogramGen::fill(unsigned long nevents, TH1 *hmomp,
+				 TH1 *hmomn, unsigned nthreads,
+				 unsigned seed)
+{
+  if (nthreads < 1) nthreads = 1;
+
+  TemplateSampler psampler(RootAdapter::make_sampler(hmomp));
+  TemplateSampler etasampler(hmomn ? RootAdapter::make_sampler(hmomn) :
+			     psampler);
+
+  // same number of events per channel as TwoBodyDecayGen::get_event_tree
+  ChannelScheduler scheduler(nthreads);
+  unsigned long naccepted(0);
+  for (unsigned chid = 0; chid < _generator.get_nchannels(); ++chid) {
+    unsigned long eff_nevents(_generator.get_brfr(chid) * nevents);
+    scheduler.add_channel(chid, eff_nevents, _chunksize);
+    naccepted += eff_nevents;
+  }
+
+  // histograms are cloned here, ROOT object creation is not thread safe
+  std::vector<Worker> workers;
+  workers.reserve(nthreads);
+  for (unsigned t = 0; t < nthreads; ++t) {
+    workers.push_back(Worker(_generator));
+    Worker &worker(workers.back());
+    worker.seed = seed;
+    worker.psampler = &psampler;
+    worker.etasampler = hmomn ? &etasampler : NULL;
+    worker.defs = &_hists;
+    worker.scheduler = &scheduler;
+    worker.id = t;
+
+    for (unsigned i = 0; i < _hists.size(); ++i) {
+      std::stringstream name;
+      name << _hists[i].hist->GetName() << "_thread" << t;
+      TH1 *hist(dynamic_cast<TH1*>(_hists[i].hist->Clone(name.str().c_str())));
+      hist->SetDirectory(NULL);
+      hist->Reset();
+      worker.hists.push_back(hist);
+    }
+  }
+
+  std::cout << "Filling " << _hists.size() << " histogram(s) with "
+	    << nevents << " events on " << nthreads << " thread(s)."
+	    << std::endl;
+
+  boost::thread_group threads;
+  for (unsigned t = 0; t < nthreads; ++t) {
+    threads.create_thread(boost::bind(&HistogramGen::_run, &workers[t]));
+  }
+  threads.join_all();
+
+  // merge thread local histograms
+  for (unsigned t = 0; t < nthreads; ++t) {
+    for (unsigned i = 0; i < _hists.size(); ++i) {
+      _hists[i].hist->Add(workers[t].hists[i]);
+      delete workers[t].hists[i];
+    }
+  }
+  unsigned long ntried(0);
+  for (unsigned chid = 0; chid < _generator.get_nchannels(); ++chid) {
+    ntried += scheduler.get_stats(chid).ntried;
+  }
+  std::cout << "Tried: " << ntried << ", accepted: " << naccepted << std::endl;
+  scheduler.print_stats();
+  return ntried;
+}
+
+
+void HistogramGen::_run(Worker *worker)
+{
+  DecayGenCore &generator(worker->generator);
+  const std::vector<HistDef> &defs(*worker->defs);
+  std::vector<double> particles(4 * generator.get_nparticles(), 0.0);
+
+  ChannelScheduler::Chunk chunk;
+  while (worker->scheduler->next(worker->id, chunk)) {
+    double start(walltime());
+    // chunks go to any thread, seed by chunk to be reproducible
+    generator.set_seed(worker->seed + chunk.index);
+    unsigned long evt(0), ntried(0);
+    while (evt < chunk.nevents) {
+      ntried++;
+      if (not generator.sample_mother(*worker->psampler, worker->etasampler,
+				      &particles[0])) {
+	continue;
+      }
+      double evt_wt(generator.generate(chunk.chid, &particles[0]));
+      if (evt_wt < 0) continue;
+
+      for (unsigned i = 0; i < defs.size(); ++i) {
+	double x((*defs[i].xobs)(&particles[0]));
+	if (defs[i].yobs) {
+	  double y((*defs[i].yobs)(&particles[0]));
+	  static_cast<TH2*>(worker->hists[i])->Fill(x, y, evt_wt);
+	} else {
+	  worker->hists[i]->Fill(x, evt_wt);
+	}
+      }
+      evt++;
+    }
+    worker->scheduler->report(chunk, ntried, walltime() - start);
+  }
+  return;
+}
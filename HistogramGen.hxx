@@ -0,0 +1,142 @@
+/**
+ * @file   HistogramGen.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 11:42:16 2026
+ *
+ * @brief  Fill histograms of observables without storing events
+ *
+ *
+ */
+
+#ifndef HISTOGRAMGEN_HXX
+#define HISTOGRAMGEN_HXX
+
+// STL headers
+#include <vector>
+
+// ROOT headers
+#include <TH1.h>
+#include <TH2.h>
+
+// package headers
+#include "DecayGenCore.hxx"
+#include "Observables.hxx"
+
+
+/**
+ * This class generates events and fills histograms of observables
+ * directly, without keeping any events.
+ *
+ * Histograms are registered together with the observable to fill
+ * them with (e.g. the momentum of a daughter, or a k-factor).  Events
+ * are generated with copies of a DecayGenCore on several threads,
+ * each thread filling its own copy of the histograms; these are
+ * added to the registered histograms at the end.  Memory use does
+ * not depend on the number of events, so this is the mode of choice
+ * for high statistics shape studies (momentum spectra, k-factors)
+ * where the event tree is not needed.
+ *
+ * Like get_event_tree in TwoBodyDecayGen, the number of events of
+ * each decay channel is fixed by its branching fraction, and only
+ * events inside the acceptance are counted.  The events of each
+ * channel are split into chunks, which are distributed over the
+ * threads by a work-stealing ChannelScheduler, so that channels with
+ * low acceptance do not leave threads idle.  The wall time spent on
+ * each channel is printed at the end.  Every chunk is generated with
+ * its own seed, derived from the chunk index, so the histograms are
+ * reproducible for a given seed and chunk size whatever the number
+ * of threads (up to rounding when the thread histograms are added).
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-21 Wed
+ *
+ */
+
+class HistogramGen {
+public:
+
+  /**
+   * Constructor
+   *
+   * The generator is copied, so options (e.g. early rejection) have
+   * to be set before.
+   *
+   * @param generator Generator with the decay channels
+   */
+  HistogramGen(const DecayGenCore &generator);
+
+  ~HistogramGen() {}
+
+  /**
+   * Register a histogram
+   *
+   * 1D histograms are filled with the observable.  Neither the
+   * histogram nor the observable is owned, and both should live
+   * until fill returns.  Entries are added to the existing
+   * contents.
+   *
+   * @param hist Histogram
+   * @param obs Observable
+   */
+  void add_histogram(TH1 *hist, const Observable *obs);
+
+  /**
+   * Register a 2D histogram
+   *
+   * @param hist Histogram
+   * @param xobs Observable along x
+   * @param yobs Observable along y
+   */
+  void add_histogram(TH2 *hist, const Observable *xobs,
+		     const Observable *yobs);
+
+  /**
+   * Set the number of events per chunk of work
+   *
+   * Smaller chunks balance the threads better, at the cost of more
+   * scheduling overhead.
+   *
+   * @param chunksize Number of accepted events per chunk
+   */
+  void set_chunk_size(unsigned long chunksize);
+
+  /**
+   * Generate events and fill the registered histograms
+   *
+   * @param nevents Number of events to generate
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param nthreads Number of threads
+   * @param seed Seed of the first chunk (incremented for the others)
+   *
+   * @return Number of tried events
+   */
+  unsigned long fill(unsigned long nevents, TH1 *hmomp, TH1 *hmomn=NULL,
+		     unsigned nthreads=1, unsigned seed=4357);
+
+private:
+
+  /**
+   * Registered histogram and observables
+   */
+  struct HistDef {
+    TH1 *hist;			/**< Histogram */
+    const Observable *xobs;	/**< Observable along x */
+    const Observable *yobs;	/**< Observable along y, NULL for 1D */
+  };
+
+  struct Worker;
+
+  /**
+   * Generate events on one thread
+   *
+   * @param worker Generator, histograms and number of events
+   */
+  static void _run(Worker *worker);
+
+  DecayGenCore _generator;	/**< Generator with decay channels */
+  std::vector<HistDef> _hists;	/**< Registered histograms */
+  unsigned long _chunksize;	/**< Events per chunk of work */
+};
+
+#endif	// HISTOGRAMGEN_HXX
@@ -0,0 +1,239 @@
+/**
+ * @file   RootAdapter.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 11:24:51 2026
+ *
+ * @brief  Conversions between ROOT objects and the ROOT independent core
+ *
+ *
+ */
+
+// STL headers
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+
+// ROOT headers
+#include <TAxis.h>
+#include <TROOT.h>
+#include <RVersion.h>
+
+// package headers
+#include "RootAdapter.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long RootAdapter::OutputSettings::_count(0);
+
+
+std::string RootAdapter::fnv1a_hex(const std::string &str)
+{
+  unsigned long long hash(14695981039346656037ULL);
+  for (unsigned i = 0; i < str.size(); ++i) {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return hex.str();
+}
+
+
+std::string RootAdapter::template_hash(TH1 *hist)
+{
+  const unsigned nbins(hist->GetNbinsX());
+  TAxis *axis(hist->GetXaxis());
+
+  std::vector<double> values(2 * nbins + 1);
+  for (unsigned i = 0; i < nbins; ++i) {
+    values[2*i] = axis->GetBinLowEdge(i + 1);
+    values[2*i + 1] = hist->GetBinContent(i + 1);
+  }
+  values[2*nbins] = axis->GetBinUpEdge(nbins);
+
+  return fnv1a_hex(std::string(reinterpret_cast<const char*>(&values[0]),
+			       values.size() * sizeof(double)));
+}
+
+
+TemplateSampler RootAdapter::make_sampler(TH1 *hist)
+{
+  const unsigned nbins(hist->GetNbinsX());
+  TAxis *axis(hist->GetXaxis());
+
+  std::vector<double> edges(nbins + 1), contents(nbins);
+  for (unsigned i = 0; i < nbins; ++i) {
+    edges[i] = axis->GetBinLowEdge(i + 1);
+    contents[i] = hist->GetBinContent(i + 1);
+  }
+  edges[nbins] = axis->GetBinUpEdge(nbins);
+
+  return TemplateSampler(nbins, &edges[0], &contents[0]);
+}
+
+
+RootAdapter::TreeSink::TreeSink(TTree *tree) :
+  _tree(tree), _evt_wt(1.0)
+{
+  _tree->Branch("particle_lvs", &_particle_lvs);
+  _tree->Branch("evt_wt", &_evt_wt, "evt_wt/D");
+}
+
+
+void RootAdapter::TreeSink::write(const double *particles,
+				  unsigned nparticles, unsigned,
+				  double weight)
+{
+  _particle_lvs.resize(nparticles);
+  for (unsigned i = 0; i < nparticles; ++i) {
+    const double *lv(particles + 4 * i);
+    _particle_lvs[i].SetPxPyPzE(lv[0], lv[1], lv[2], lv[3]);
+  }
+  _evt_wt = weight;
+  _tree->Fill();
+  return;
+}
+
+
+RootAdapter::OutputSettings::OutputSettings(Codec codec, int level,
+					    unsigned nthreads,
+					    Long64_t clusterbytes) :
+  _codec(codec), _level(std::min(std::max(level, 0), 9)),
+  _nthreads(nthreads), _clusterbytes(clusterbytes)
+{}
+
+
+bool RootAdapter::OutputSettings::parse(std::string spec)
+{
+  static const char *names[4] = {"zlib", "lzma", "lz4", "zstd"};
+  static const Codec codecs[4] = {ZLIB, LZMA, LZ4, ZSTD};
+
+  std::string name(spec.substr(0, spec.find(':')));
+  for (unsigned i = 0; i < 4; ++i) {
+    if (name != names[i]) continue;
+    _codec = codecs[i];
+    if (name.size() < spec.size()) {
+      _level = std::min(std::max(std::atoi(spec.c_str() + name.size() + 1),
+				 0), 9);
+    }
+    return true;
+  }
+  ERROR("Unknown compression codec: " << name);
+  return false;
+}
+
+
+int RootAdapter::OutputSettings::get_compression() const
+{
+  Codec codec(_codec);
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,20,0)
+  if (codec == ZSTD) {
+    WARNING("zstd needs ROOT 6.20, using zlib.");
+    codec = ZLIB;
+  }
+#endif
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,10,0)
+  if (codec == LZ4) {
+    WARNING("LZ4 needs ROOT 6.10, using zlib.");
+    codec = ZLIB;
+  }
+#endif
+  return 100 * codec + _level;
+}
+
+
+Long64_t RootAdapter::OutputSettings::get_cluster_entries(double eventbytes)
+  const
+{
+  return std::max(Long64_t(_clusterbytes / std::max(eventbytes, 1.0)),
+		  Long64_t(1));
+}
+
+
+std::string RootAdapter::OutputSettings::str() const
+{
+  std::ostringstream desc;
+  switch (_codec) {
+  case LZMA: desc << "lzma"; break;
+  case LZ4: desc << "lz4"; break;
+  case ZSTD: desc << "zstd"; break;
+  default: desc << "zlib";
+  }
+  desc << ":" << _level << ", " << _nthreads << " thread(s)";
+  return desc.str();
+}
+
+
+void RootAdapter::OutputSettings::apply(TFile *file) const
+{
+  file->SetCompressionSettings(get_compression());
+  return;
+}
+
+
+bool RootAdapter::OutputSettings::enable_threads() const
+{
+  if (_nthreads == 0) return true;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+  // trees flush baskets in parallel tasks from now on
+  ROOT::EnableImplicitMT(_nthreads);
+  return true;
+#else
+  WARNING("Parallel basket compression needs ROOT 6.10, ignoring threads.");
+  return false;
+#endif
+}
+
+
+RootAdapter::FlatTreeSink::FlatTreeSink(TTree *tree, unsigned maxparticles,
+					const OutputSettings *settings) :
+  _tree(tree), _nparticles(0), _evt_wt(1.0), _chid(0)
+{
+  const char *names[4] = {"px", "py", "pz", "E"};
+  _tree->Branch("nparticles", &_nparticles, "nparticles/i");
+  for (unsigned i = 0; i < 4; ++i) {
+    _lvs[i].resize(maxparticles, 0.0);
+    std::string leaflist(std::string(names[i]) + "[nparticles]/D");
+    _tree->Branch(names[i], &_lvs[i][0], leaflist.c_str());
+  }
+  _tree->Branch("evt_wt", &_evt_wt, "evt_wt/D");
+  _tree->Branch("chid", &_chid, "chid/i");
+
+  if (not settings) return;
+
+  // one basket per branch and cluster, for the largest events; the
+  // array baskets also hold an entry offset per event
+  double eventbytes(4 * 8.0 * maxparticles + 8 + 2 * 4);
+  Long64_t nentries(settings->get_cluster_entries(eventbytes));
+  const Long64_t minbasket(32000), maxbasket(16000000);
+  Long64_t arraybasket(nentries * (8 * maxparticles + 4));
+  Long64_t wtbasket(nentries * 8), intbasket(nentries * 4);
+  _tree->SetAutoFlush(nentries);
+  _tree->SetBasketSize("*", std::min(std::max(intbasket, minbasket),
+				      maxbasket));
+  _tree->SetBasketSize("evt_wt", std::min(std::max(wtbasket, minbasket),
+					  maxbasket));
+  for (unsigned i = 0; i < 4; ++i) {
+    _tree->SetBasketSize(names[i], std::min(std::max(arraybasket, minbasket),
+					    maxbasket));
+  }
+}
+
+
+void RootAdapter::FlatTreeSink::write(const double *particles,
+				      unsigned nparticles, unsigned chid,
+				      double weight)
+{
+  _nparticles = std::min(nparticles, unsigned(_lvs[0].size()));
+  for (unsigned i = 0; i < _nparticles; ++i) {
+    for (unsigned j = 0; j < 4; ++j) {
+      _lvs[j][i] = particles[4*i + j];
+    }
+  }
+  _evt_wt = weight;
+  _chid = chid;
+  _tree->Fill();
+  return;
+}
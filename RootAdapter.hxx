@@ -0,0 +1,234 @@
+/**
+ * @file   RootAdapter.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 11:20:07 2026
+ *
+ * @brief  Conversions between ROOT objects and the ROOT independent core
+ *
+ *
+ */
+
+#ifndef ROOTADAPTER_HXX
+#define ROOTADAPTER_HXX
+
+// STL headers
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include <TH1.h>
+#include <TTree.h>
+#include <TFile.h>
+#include <TLorentzVector.h>
+
+// package headers
+#include "TemplateSampler.hxx"
+#include "PipelineGen.hxx"
+
+
+namespace RootAdapter {
+
+  /**
+   * Stable 64-bit FNV-1a hash, used to name cached objects in ROOT files
+   *
+   * @param str String to hash
+   *
+   * @return Hash as a hexadecimal string
+   */
+  std::string fnv1a_hex(const std::string &str);
+
+  /**
+   * Hash of the bin edges and contents of a 1D histogram
+   *
+   * Under- and overflow bins are ignored, like TH1::GetRandom.
+   *
+   * @param hist Template histogram
+   *
+   * @return Hash as a hexadecimal string
+   */
+  std::string template_hash(TH1 *hist);
+
+  /**
+   * Make a template sampler from a 1D histogram
+   *
+   * Under- and overflow bins are ignored, like TH1::GetRandom.
+   *
+   * @param hist Template histogram
+   *
+   * @return Template sampler with the same binning and contents
+   */
+  TemplateSampler make_sampler(TH1 *hist);
+
+  /**
+   * Event sink filling a tree like TwoBodyDecayGen::get_event_tree
+   *
+   * The tree has the particle_lvs and evt_wt branches.  It is filled
+   * from the serialisation stage of PipelineGen, and should not be
+   * used by other threads meanwhile.
+   */
+  class TreeSink : public EventSink {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param tree Tree to add the branches to and fill
+     */
+    TreeSink(TTree *tree);
+
+    void write(const double *particles, unsigned nparticles,
+	       unsigned chid, double weight);
+
+  private:
+
+    TTree *_tree;		/**< Output tree */
+    std::vector<TLorentzVector> _particle_lvs; /**< Generated 4-momenta */
+    double _evt_wt;		/**< Event weight */
+  };
+
+
+  /**
+   * Compression and basket layout of output files
+   *
+   * The codec and level are set on the file, and apply to all trees
+   * created in it afterwards.  With helper threads, ROOT (6.10 or
+   * newer) compresses the baskets of different branches in parallel
+   * (implicit multi-threading, see enable_threads).  Codecs not
+   * supported by the ROOT version in use fall back to zlib: LZ4 needs
+   * ROOT 6.10 and zstd ROOT 6.20.
+   *
+   * Baskets of flat trees (FlatTreeSink) are sized so that a cluster
+   * of events (entries written and compressed together) holds about
+   * the given number of uncompressed bytes, with one basket per
+   * branch and cluster.
+   */
+  class OutputSettings {
+  public:
+
+    /**
+     * Compression codecs (ROOT algorithm numbers)
+     */
+    enum Codec { ZLIB = 1, LZMA = 2, LZ4 = 4, ZSTD = 5 };
+
+    /**
+     * Constructor
+     *
+     * @param codec Compression codec
+     * @param level Compression level (0 for no compression, up to 9)
+     * @param nthreads Helper threads compressing baskets (0 for none)
+     * @param clusterbytes Uncompressed bytes per cluster
+     */
+    OutputSettings(Codec codec=ZLIB, int level=1, unsigned nthreads=0,
+		   Long64_t clusterbytes=32000000);
+
+    /**
+     * Parse settings from a string like "zstd:5"
+     *
+     * Codecs are zlib, lzma, lz4 and zstd, the level is optional.
+     *
+     * @param spec Codec and level
+     *
+     * @return Status (false if the codec is unknown)
+     */
+    bool parse(std::string spec);
+
+    /**
+     * Set number of helper threads compressing baskets
+     *
+     * @param nthreads Number of threads (0 for none)
+     */
+    void set_threads(unsigned nthreads) { _nthreads = nthreads; }
+
+    /**
+     * Return ROOT compression setting (100 × algorithm + level)
+     *
+     * @return Compression setting, after falling back to zlib
+     */
+    int get_compression() const;
+
+    /**
+     * Return number of events per cluster
+     *
+     * @param eventbytes Uncompressed bytes per event
+     *
+     * @return Events per cluster
+     */
+    Long64_t get_cluster_entries(double eventbytes) const;
+
+    /**
+     * Return a description like "zstd:5, 4 threads"
+     *
+     * @return Description
+     */
+    std::string str() const;
+
+    /**
+     * Set compression of a file
+     *
+     * Call before creating trees in the file.  Helper threads are not
+     * started here, see enable_threads.
+     *
+     * @param file Output file
+     */
+    void apply(TFile *file) const;
+
+    /**
+     * Enable ROOT implicit multi-threading with the helper threads
+     *
+     * This is global to the process: it applies to all trees written
+     * (or read) afterwards, not only to files set up with apply, and
+     * stays on until ROOT::DisableImplicitMT is called.  Does nothing
+     * without helper threads.
+     *
+     * @return False if not supported by the ROOT version in use
+     */
+    bool enable_threads() const;
+
+  private:
+
+    static unsigned long long _count; /**< Debug message counter */
+    Codec _codec;		/**< Compression codec */
+    int _level;			/**< Compression level */
+    unsigned _nthreads;		/**< Helper threads */
+    Long64_t _clusterbytes;	/**< Uncompressed bytes per cluster */
+  };
+
+
+  /**
+   * Event sink filling a tree with flat branches
+   *
+   * Instead of a vector of TLorentzVector objects, the 4-momentum
+   * components of all particles are stored as variable length arrays
+   * (px, py, pz and E, with nparticles entries), with the evt_wt and
+   * chid branches.  The plain numbers compress much better and can be
+   * read without dictionaries.  Basket sizes and the cluster size are
+   * set from the event size (see OutputSettings).
+   */
+  class FlatTreeSink : public EventSink {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param tree Tree to add the branches to and fill
+     * @param maxparticles Number of particles in the largest decay channel
+     * @param settings Output settings for the basket layout, optional
+     */
+    FlatTreeSink(TTree *tree, unsigned maxparticles,
+		 const OutputSettings *settings=NULL);
+
+    void write(const double *particles, unsigned nparticles,
+	       unsigned chid, double weight);
+
+  private:
+
+    TTree *_tree;		/**< Output tree */
+    UInt_t _nparticles;		/**< Number of particles */
+    std::vector<double> _lvs[4]; /**< px, py, pz and E of all particles */
+    double _evt_wt;		/**< Event weight */
+    UInt_t _chid;		/**< Decay channel id */
+  };
+
+}
+
+#endif	// ROOTADAPTER_HXX
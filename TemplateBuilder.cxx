@@ -0,0 +1,271 @@
+/**
+ * @file   TemplateBuilder.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Sun Oct 25 11:37:09 2026
+ *
+ * @brief  Implementation of TemplateBuilder
+ *
+ *
+ */
+
+// STL headers
+#include <vector>
+#include <sstream>
+
+// Boost headers
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+// ROOT headers
+#include <TFile.h>
+#include <TSystem.h>
+#include <TThread.h>
+#include <TLorentzVector.h>
+
+// package headers
+#include "TemplateBuilder.hxx"
+#include "RootAdapter.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long TemplateBuilder::_count(0);
+
+
+/**
+ * Suffixes of the cached templates
+ */
+static const char *SUFFIXES[3] = {"_p", "_eta", "_peta"};
+
+
+TemplateBuilder::TemplateBuilder(std::string fname, std::string treename,
+				 std::string branch, double scale) :
+  _fname(fname), _treename(treename), _branch(branch), _scale(scale),
+  _select(false), _nthreads(1)
+{
+  _prange[0] = _prange[1] = 0.0;
+  _etarange[0] = _etarange[1] = 0.0;
+}
+
+
+void TemplateBuilder::set_selection(double pmin, double pmax, double etamin,
+				    double etamax)
+{
+  _prange[0] = pmin;
+  _prange[1] = pmax;
+  _etarange[0] = etamin;
+  _etarange[1] = etamax;
+  _select = true;
+  return;
+}
+
+
+void TemplateBuilder::set_cache(std::string fname)
+{
+  _cachefile = fname;
+  return;
+}
+
+
+void TemplateBuilder::set_threads(unsigned nthreads)
+{
+  _nthreads = nthreads < 1 ? 1 : nthreads;
+  return;
+}
+
+
+std::string TemplateBuilder::get_key(TH1 *hmomp, TH1 *hmomn, TH2 *hmompn)
+{
+  Long_t id(0), flags(0), modtime(0);
+  Long64_t size(0);
+  if (gSystem->GetPathInfo(_fname.c_str(), &id, &size, &flags, &modtime)) {
+    return "";
+  }
+
+  std::ostringstream key;
+  key << _fname << "(" << size << "," << modtime << ") " << _treename
+      << ":" << _branch << "*" << _scale;
+  if (_select) {
+    key << " sel[p(" << _prange[0] << "," << _prange[1] << ") eta("
+	<< _etarange[0] << "," << _etarange[1] << ")]";
+  }
+  TH1 *hists[3] = {hmomp, hmomn, hmompn};
+  for (unsigned i = 0; i < 3; ++i) {
+    if (not hists[i]) continue;
+    key << " " << SUFFIXES[i] + 1 << "[" << hists[i]->GetNbinsX() << ","
+	<< hists[i]->GetXaxis()->GetXmin() << ","
+	<< hists[i]->GetXaxis()->GetXmax();
+    if (hists[i]->GetDimension() > 1) {
+      key << "," << hists[i]->GetNbinsY() << ","
+	  << hists[i]->GetYaxis()->GetXmin() << ","
+	  << hists[i]->GetYaxis()->GetXmax();
+    }
+    key << "]";
+  }
+  return key.str();
+}
+
+
+bool TemplateBuilder::build(TH1 *hmomp, TH1 *hmomn, TH2 *hmompn)
+{
+  TH1 *hists[3] = {hmomp, hmomn, hmompn};
+  for (unsigned i = 0; i < 3; ++i) {
+    if (hists[i]) hists[i]->Reset();
+  }
+
+  std::string key(get_key(hmomp, hmomn, hmompn));
+  if (key.empty()) {
+    ERROR("Could not find input file " << _fname);
+    return false;
+  }
+  std::string name("templates_" + RootAdapter::fnv1a_hex(key));
+  if (not _cachefile.empty() and _read_cache(name, key, hists)) {
+    DEBUG("Read templates for " << key);
+    return true;
+  }
+
+  // ROOT I/O from several threads
+  TThread::Initialize();
+
+  // files and histograms are created here, this is not thread safe
+  TDirectory *olddir(gDirectory);
+  std::vector<TFile*> files;
+  std::vector<TTree*> trees;
+  std::vector<TH1*> whists(3 * _nthreads, NULL);
+  bool status(true);
+  for (unsigned t = 0; t < _nthreads and status; ++t) {
+    TFile *file(TFile::Open(_fname.c_str(), "read"));
+    TTree *tree(file ? dynamic_cast<TTree*>(file->Get(_treename.c_str())) : NULL);
+    if (file) files.push_back(file);
+    if (not tree) {
+      ERROR("Could not read " << _treename << " from " << _fname);
+      status = false;
+      break;
+    }
+    // only read the mother branch
+    tree->SetBranchStatus("*", false);
+    tree->SetBranchStatus((_branch + "*").c_str(), true);
+    trees.push_back(tree);
+
+    for (unsigned i = 0; i < 3; ++i) {
+      if (not hists[i]) continue;
+      std::ostringstream hname;
+      hname << hists[i]->GetName() << "_thread" << t;
+      TH1 *hist(dynamic_cast<TH1*>(hists[i]->Clone(hname.str().c_str())));
+      hist->SetDirectory(NULL);
+      whists[3*t + i] = hist;
+    }
+  }
+
+  if (status) {
+    const Long64_t nentries(trees[0]->GetEntries());
+    boost::thread_group threads;
+    for (unsigned t = 0; t < _nthreads; ++t) {
+      Long64_t first(nentries * t / _nthreads),
+	last(nentries * (t + 1) / _nthreads);
+      threads.create_thread(boost::bind(&TemplateBuilder::_fill, this,
+					trees[t], first, last, &whists[3*t]));
+    }
+    threads.join_all();
+
+    for (unsigned i = 0; i < 3 * _nthreads; ++i) {
+      if (whists[i]) hists[i % 3]->Add(whists[i]);
+    }
+    DEBUG("Filled templates from " << nentries << " entries");
+  }
+
+  for (unsigned i = 0; i < whists.size(); ++i) delete whists[i];
+  for (unsigned i = 0; i < files.size(); ++i) {
+    files[i]->Close();
+    delete files[i];
+  }
+  olddir->cd();
+
+  if (status and not _cachefile.empty()) _write_cache(name, key, hists);
+  return status;
+}
+
+
+void TemplateBuilder::_fill(TTree *tree, Long64_t first, Long64_t last,
+			    TH1 **hists)
+{
+  TLorentzVector *mother(NULL);
+  tree->SetBranchAddress(_branch.c_str(), &mother);
+
+  for (Long64_t entry = first; entry < last; ++entry) {
+    tree->GetEntry(entry);
+    double p(_scale * mother->P()), eta(mother->Eta());
+    if (_select and (p < _prange[0] or _prange[1] < p or
+		     eta < _etarange[0] or _etarange[1] < eta)) {
+      continue;
+    }
+    if (hists[0]) hists[0]->Fill(p);
+    if (hists[1]) hists[1]->Fill(eta);
+    if (hists[2]) static_cast<TH2*>(hists[2])->Fill(p, eta);
+  }
+
+  tree->ResetBranchAddresses();
+  delete mother;
+  return;
+}
+
+
+bool TemplateBuilder::_read_cache(std::string name, std::string key,
+				  TH1 *hists[3])
+{
+  if (gSystem->AccessPathName(_cachefile.c_str())) return false; // no file
+
+  TDirectory *olddir(gDirectory);
+  TFile *cache(TFile::Open(_cachefile.c_str(), "read"));
+  if (not cache or cache->IsZombie()) {
+    ERROR("Could not open template cache " << _cachefile);
+    delete cache;
+    olddir->cd();
+    return false;
+  }
+
+  // all requested templates have to be there
+  bool found(true);
+  TH1 *cached[3] = {NULL, NULL, NULL};
+  for (unsigned i = 0; i < 3 and found; ++i) {
+    if (not hists[i]) continue;
+    cached[i] = dynamic_cast<TH1*>(cache->Get((name + SUFFIXES[i]).c_str()));
+    found = cached[i] and key == cached[i]->GetTitle();
+  }
+  for (unsigned i = 0; i < 3 and found; ++i) {
+    if (hists[i]) hists[i]->Add(cached[i]);
+  }
+
+  cache->Close();
+  delete cache;
+  olddir->cd();
+  return found;
+}
+
+
+void TemplateBuilder::_write_cache(std::string name, std::string key,
+				   TH1 *hists[3])
+{
+  TDirectory *olddir(gDirectory);
+  TFile *cache(TFile::Open(_cachefile.c_str(), "update"));
+  if (not cache or cache->IsZombie()) {
+    ERROR("Could not open template cache " << _cachefile);
+    delete cache;
+    olddir->cd();
+    return;
+  }
+
+  for (unsigned i = 0; i < 3; ++i) {
+    if (not hists[i]) continue;
+    TH1 *copy(dynamic_cast<TH1*>(hists[i]->Clone((name + SUFFIXES[i]).c_str())));
+    copy->SetTitle(key.c_str());
+    if (cache->WriteTObject(copy, NULL, "Overwrite") <= 0) {
+      ERROR("Could not write template " << copy->GetName());
+    }
+    delete copy;
+  }
+
+  cache->Close();
+  delete cache;
+  olddir->cd();
+  return;
+}
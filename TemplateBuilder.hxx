@@ -0,0 +1,153 @@
+/**
+ * @file   TemplateBuilder.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Sun Oct 25 10:21:43 2026
+ *
+ * @brief  Build mother kinematics templates from input ntuples
+ *
+ *
+ */
+
+#ifndef TEMPLATEBUILDER_HXX
+#define TEMPLATEBUILDER_HXX
+
+// STL headers
+#include <string>
+
+// ROOT headers
+#include <TH1.h>
+#include <TH2.h>
+#include <TTree.h>
+
+
+/**
+ * This class fills the momentum and pseudorapidity templates of the
+ * mother particle (as used by TwoBodyDecayGen::get_event_tree) from a
+ * TLorentzVector branch of an input tree.
+ *
+ * Unlike TTree::Draw, only the TLorentzVector branch is read, no
+ * formula is interpreted and nothing is drawn.  The entries are
+ * split in ranges read in parallel, each thread with its own file
+ * handle and histograms, which are added up at the end.  Optionally
+ * a 2D p–η template is filled as well.
+ *
+ * If a cache file is set, the templates are saved there, and read
+ * back instead of being refilled when the input file (name, size and
+ * modification time), tree, branch, selection and binning are the
+ * same.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-25 Sun
+ *
+ */
+
+class TemplateBuilder {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param fname Input ROOT file
+   * @param treename Input tree
+   * @param branch TLorentzVector branch of the mother particle
+   * @param scale Momentum scale, e.g. 1E-3 for MeV/c → GeV/c
+   */
+  TemplateBuilder(std::string fname, std::string treename="ftree",
+		  std::string branch="tru_BsMom", double scale=1E-3);
+
+  ~TemplateBuilder() {}
+
+  /**
+   * Only use mothers inside a momentum and pseudorapidity range
+   *
+   * @param pmin Lower bound on momentum (after scaling)
+   * @param pmax Upper bound on momentum (after scaling)
+   * @param etamin Lower bound on η
+   * @param etamax Upper bound on η
+   */
+  void set_selection(double pmin, double pmax, double etamin, double etamax);
+
+  /**
+   * Use a ROOT file to cache templates between runs
+   *
+   * @param fname ROOT file name (created if it does not exist)
+   */
+  void set_cache(std::string fname);
+
+  /**
+   * Set number of threads reading the input
+   *
+   * @param nthreads Number of threads
+   */
+  void set_threads(unsigned nthreads);
+
+  /**
+   * Fill templates
+   *
+   * The histograms are reset and filled; their binning is used as
+   * given.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param hmompn 2D template of momentum (x) and η (y), optional
+   *
+   * @return Status (false if the input could not be read)
+   */
+  bool build(TH1 *hmomp, TH1 *hmomn, TH2 *hmompn=NULL);
+
+  /**
+   * Return a key describing the input, selection and binning
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param hmompn 2D template of momentum and η, optional
+   *
+   * @return Key (empty if the input file does not exist)
+   */
+  std::string get_key(TH1 *hmomp, TH1 *hmomn, TH2 *hmompn=NULL);
+
+private:
+
+  /**
+   * Read templates from the cache
+   *
+   * @param name Cache object name
+   * @param key Key, checked against the cached templates
+   * @param hists Templates to fill (p, η, p–η)
+   *
+   * @return If found
+   */
+  bool _read_cache(std::string name, std::string key, TH1 *hists[3]);
+
+  /**
+   * Write templates to the cache
+   *
+   * @param name Cache object name
+   * @param key Key
+   * @param hists Templates to save (p, η, p–η)
+   */
+  void _write_cache(std::string name, std::string key, TH1 *hists[3]);
+
+  /**
+   * Fill templates from a range of entries
+   *
+   * @param tree Input tree (owned by the calling thread)
+   * @param first First entry
+   * @param last One past the last entry
+   * @param hists Templates to fill (p, η, p–η)
+   */
+  void _fill(TTree *tree, Long64_t first, Long64_t last, TH1 **hists);
+
+  static unsigned long long _count; /**< Debug message counter */
+  std::string _fname;		/**< Input file */
+  std::string _treename;	/**< Input tree */
+  std::string _branch;		/**< Mother TLorentzVector branch */
+  double _scale;		/**< Momentum scale */
+  bool _select;			/**< Apply selection */
+  double _prange[2];		/**< Selected momentum range */
+  double _etarange[2];		/**< Selected η range */
+  std::string _cachefile;	/**< Template cache file */
+  unsigned _nthreads;		/**< Number of threads */
+};
+
+#endif	// TEMPLATEBUILDER_HXX
@@ -11,6 +11,8 @@
 // STL headers
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <algorithm>
 
 /**
  * \def _USE_MATH_DEFINES
@@ -24,42 +26,15 @@
 
 // ROOT headers
 #include <TRandom3.h>
+#include <TFile.h>
+#include <TSystem.h>
 
 // package headers
 #include "TwoBodyDecayGen.hxx"
-
-
-/**
- * \def DEBUG(MSG)
- * Debug statement with a counter
- */
-
-#define DEBUG(MSG)  \
-  std::cout << "DEBUG: [" << std::setw(4) << std::setfill('0') << _count \
-  << "] (" << __func__ << ") " << MSG << std::endl; \
-  _count++;
-
-
-/**
- * \def WARNING(MSG)
- * Warning with a counter
- */
-
-#define WARNING(MSG)  \
-  std::cout << "WARNING: [" << std::setw(4) << std::setfill('0') << _count \
-  << "] (" << __func__ << ") " << MSG << std::endl; \
-  _count++;
-
-
-/**
- * \def ERROR(MSG)
- * Error message with a counter
- */
-
-#define ERROR(MSG)  \
-  std::cout << "ERROR: [" << std::setw(4) << std::setfill('0') << _count \
-  << "] (" << __func__ << ") "	<< MSG << std::endl; \
-  _count++;
+#include "AcceptanceMap.hxx"
+#include "RootAdapter.hxx"
+#include "DecayGenCore.hxx"
+#include "DecayGenMessages.hxx"
 
 
 void TwoBodyDecayGen::_printQ(std::string prefix, std::deque<chBFpair> queue)
@@ -90,6 +65,8 @@ TwoBodyDecayGen::TwoBodyDecayGen(double mommass,
 				 double dau2mass,
 				 TwoBodyDecayGen *dau1,
 				 TwoBodyDecayGen *dau2) :
+  _full_accept(false), _early_reject(false), _cut_mother_eta(false),
+  _eta_warned(false), _npilot(0), _is_floor(0.01),
   _generator(TGenPhaseSpace()), _mommass(mommass)
 {
   _daumasses[0] = dau1mass;
@@ -107,6 +84,8 @@ TwoBodyDecayGen::TwoBodyDecayGen(double mommass,
 TwoBodyDecayGen::TwoBodyDecayGen(double mommass, double *daumasses,
 				 TwoBodyDecayGen *dau1,
 				 TwoBodyDecayGen *dau2) :
+  _full_accept(false), _early_reject(false), _cut_mother_eta(false),
+  _eta_warned(false), _npilot(0), _is_floor(0.01),
   _generator(TGenPhaseSpace()), _mommass(mommass)//, _daumasses(daumasses)
   // c++11 only, compile with -std=c++11 or -std=gnu++11
   // _daumasses{dau1, dau2} {}
@@ -124,6 +103,8 @@ TwoBodyDecayGen::TwoBodyDecayGen(double mommass, double *daumasses,
 
 
 TwoBodyDecayGen::TwoBodyDecayGen(double *masses, unsigned nparts) :
+  _full_accept(false), _early_reject(false), _cut_mother_eta(false),
+  _eta_warned(false), _npilot(0), _is_floor(0.01),
   _generator(TGenPhaseSpace()), _mommass(masses[0])
 {
   _daumasses[0] = masses[1];
@@ -166,19 +147,7 @@ bool TwoBodyDecayGen::add_decay_channel(double *masses, unsigned nparts,
   }
 
   std::vector<double> dau1tree, dau2tree;
-
-  const unsigned nodes = (nparts - 1) / 2;
-  for (unsigned i = 1; i < nodes; ++i) {
-    if (i % 2) {
-      if (i == 1) dau1tree.push_back(masses[i]);
-      dau1tree.push_back(masses[2*i + 1]);
-      dau1tree.push_back(masses[2*i + 2]);
-    } else {
-      if (i == 2) dau2tree.push_back(masses[i]);
-      dau2tree.push_back(masses[2*i + 1]);
-      dau2tree.push_back(masses[2*i + 2]);
-    }
-  }
+  DecayGenCore::split_daughter_trees(masses, nparts, dau1tree, dau2tree);
 
   std::vector<TwoBodyDecayGen*> daus(NDAUS, NULL);
   if (not dau1tree.empty()) {
@@ -213,6 +182,25 @@ double TwoBodyDecayGen::get_brfr(unsigned chid)
 }
 
 
+bool TwoBodyDecayGen::set_brfr(unsigned chid, double brfr)
+{
+  if (chid == 0 or chid >= _dauchannels.size()) {
+    ERROR("Invalid decay channel " << chid << ", BF not changed.");
+    return false;
+  }
+
+  // same as add_decay_channel, the primary channel takes the rest
+  double rest(_dauchannels[0].second + _dauchannels[chid].second - brfr);
+  if (brfr < 0.0 or rest < 0.0) {
+    ERROR("Branching fraction " << brfr << " out of range, BF not changed.");
+    return false;
+  }
+  _dauchannels[chid].second = brfr;
+  _dauchannels[0].second = rest;
+  return true;
+}
+
+
 int TwoBodyDecayGen::find_leaf_nodes(std::vector<std::deque<chBFpair> > &brfrVec,
 				      std::deque<chBFpair> &brfrQ)
 {
@@ -256,7 +244,8 @@ int TwoBodyDecayGen::find_leaf_nodes(std::vector<std::deque<chBFpair> > &brfrVec
 
 double TwoBodyDecayGen::generate(TLorentzVector &momp,
 				 std::vector<TLorentzVector> &particle_lvs,
-				 std::deque<chBFpair> chQ)
+				 std::deque<chBFpair> chQ, bool full,
+				 bool early)
 {
   // setup decay and generate
   if (not _generator.SetDecay(momp, NDAUS, _daumasses)) {
@@ -268,8 +257,15 @@ double TwoBodyDecayGen::generate(TLorentzVector &momp,
   for (unsigned j = 0; j < NDAUS; ++j) {
     particle_lvs.push_back(*(_generator.GetDecay(j)));
   }
+  const unsigned idau(particle_lvs.size() - NDAUS); // first daughter
 
   if (chQ.empty()) { // at leaf node, return
+    if (full) { // both daughters are final-state particles
+      for (unsigned j = idau; j < particle_lvs.size(); ++j) {
+	if (not lv_in_LHCb(particle_lvs[j])) return -100;
+      }
+      return evt_wt;
+    }
     // TODO: check if daughters are inside LHCb detector acceptance
     if (lv_in_LHCb(particle_lvs.back())) {
       return evt_wt;
@@ -281,6 +277,19 @@ double TwoBodyDecayGen::generate(TLorentzVector &momp,
   unsigned ich(chQ.front().first);
   chQ.pop_front();
 
+  // final-state daughters are known now, without early rejection the
+  // rest of the tree is still decayed
+  bool outside(false);
+  if (full) {
+    for (unsigned j = 0; j < NDAUS; ++j) {
+      if (not _dauchannels[ich].first[j] and
+	  not lv_in_LHCb(particle_lvs[idau + j])) {
+	outside = true;
+      }
+    }
+    if (outside and early) return -100;
+  }
+
   // DEBUG("ich/_dauchannels size: " << ich + 1 << "/" << _dauchannels.size());
 
   // propagate generate to daughters
@@ -288,63 +297,333 @@ double TwoBodyDecayGen::generate(TLorentzVector &momp,
     // DEBUG("pointer: " << _dauchannels[ich].first[j]);
     if (_dauchannels[ich].first[j]) {
       // FIXME: Check for -ve weights, and propagate appropriately
-      double wt = _dauchannels[ich].first[j]->generate(particle_lvs[j+1],
-						       particle_lvs, chQ);
+      // copy, particle_lvs grows while the daughter decays
+      TLorentzVector daulv(particle_lvs[idau + j]);
+      double wt = _dauchannels[ich].first[j]->generate(daulv, particle_lvs,
+						       chQ, full, early);
       if (0.0 < wt) {
 	evt_wt += wt;
 	evt_wt /= 2.0;
-      } else {
+      } else if (wt == -100 and not early) {
 	// DEBUG("Daughter outside LHCb acceptance!");
+	outside = true;
+      } else {
 	return wt;
       }
     }
   } // FIXME: the handling of weights is probably wrong
 
-  return evt_wt;
+  return outside ? -100 : evt_wt;
 }
 
 
 bool TwoBodyDecayGen::lv_in_LHCb(TLorentzVector &part_lv)
 {
-  // - x-z plane: 10 - 300 mrad
-  // - y-z plane: 10 - 250 mrad
-  const double xz_slope_lo(std::tan(1E-2)), xz_slope_hi(std::tan(3E-1)),
-    yz_slope_lo(std::tan(1E-2)), yz_slope_hi(std::tan(2.5E-1));
+  double lv[4] = {part_lv.Px(), part_lv.Py(), part_lv.Pz(), part_lv.E()};
+  return DecayKinematics::in_LHCb(lv);
+}
+
+
+void TwoBodyDecayGen::set_full_acceptance(bool full)
+{
+  _full_accept = full;
+  return;
+}
+
+
+void TwoBodyDecayGen::set_early_rejection(bool early)
+{
+  _early_reject = early;
+  return;
+}
+
+
+void TwoBodyDecayGen::set_mother_eta_range(double etalo, double etahi)
+{
+  if (etahi < etalo) {
+    ERROR("Invalid η range (" << etalo << ", " << etahi << "), ignoring.");
+    return;
+  }
+  _mother_eta[0] = etalo;
+  _mother_eta[1] = etahi;
+  _cut_mother_eta = true;
+  return;
+}
 
-  double px(part_lv.Px()), py(part_lv.Py()), pz(part_lv.Pz());
-  double xz_slope(std::fabs(px/pz)), yz_slope(std::fabs(py/pz));
 
-  if (xz_slope_lo < xz_slope and xz_slope < xz_slope_hi and
-      yz_slope_lo < yz_slope and yz_slope < yz_slope_hi) {
+bool TwoBodyDecayGen::sample_mother(TH1 *hmomp, TH1 *hmomn,
+				    TLorentzVector &momp)
+{
+  if (not hmomn) {
+    if (_cut_mother_eta and not _eta_warned) {
+      WARNING("No mother η template, the mother η range is not applied.");
+      _eta_warned = true;
+    }
+    momp.SetXYZM(0.0, 0.0, hmomp->GetRandom(), _mommass);
     return true;
   }
 
-  return false;
+  double eta(hmomn->GetRandom());
+  // cheap pre-selection, before sampling anything else
+  if (_cut_mother_eta and
+      (eta < _mother_eta[0] or _mother_eta[1] < eta)) {
+    return false;
+  }
+  double pt(hmomp->GetRandom() / std::cosh(eta));
+  double phi(2 * M_PI * gRandom->Rndm());	// get random ∈ [0, 2π)
+  momp.SetPtEtaPhiM(pt, eta, phi, _mommass);
+  return true;
+}
+
+
+void TwoBodyDecayGen::set_importance_sampling(unsigned npilot, double floor)
+{
+  _npilot = npilot;
+  _is_floor = floor;
+  return;
+}
+
+
+void TwoBodyDecayGen::set_acceptance_cache(std::string fname)
+{
+  _accfile = fname;
+  return;
+}
+
+
+std::string TwoBodyDecayGen::get_channel_key(std::deque<chBFpair> chQ)
+{
+  std::ostringstream key;
+  key << std::setprecision(6) << _mommass << ">(";
+
+  if (chQ.empty()) { // at leaf node
+    key << _daumasses[0] << "," << _daumasses[1] << ")";
+    return key.str();
+  }
+  // same traversal as generate
+  unsigned ich(chQ.front().first);
+  chQ.pop_front();
+
+  for (unsigned j = 0; j < NDAUS; ++j) {
+    if (j > 0) key << ",";
+    if (_dauchannels[ich].first[j]) {
+      key << _dauchannels[ich].first[j]->get_channel_key(chQ);
+    } else {
+      key << _daumasses[j];
+    }
+  }
+  key << ")";
+  return key.str();
+}
+
+
+std::string TwoBodyDecayGen::get_acceptance_key(bool full)
+{
+  std::ostringstream key;
+  key << "LHCb xz(" << DecayKinematics::XZ_ANGLE_LO << ","
+      << DecayKinematics::XZ_ANGLE_HI << ") yz("
+      << DecayKinematics::YZ_ANGLE_LO << ","
+      << DecayKinematics::YZ_ANGLE_HI << ") "
+      << (full ? "all final-state" : "last particle");
+  return key.str();
+}
+
+
+AcceptanceMap* TwoBodyDecayGen::get_acceptance_map(std::deque<chBFpair> chQ,
+						   TH1 *hmomp, TH1 *hmomn,
+						   unsigned nevents)
+{
+  AcceptanceMap *accmap = new AcceptanceMap(hmomp, hmomn);
+
+  // describe everything the map depends on
+  std::ostringstream title;
+  title << get_channel_key(chQ) << " " << get_acceptance_key(_full_accept);
+  for (unsigned axis = 0; axis < 2; ++axis) {
+    title << (axis ? " eta[" : " p[") << accmap->get_nbins(axis) << ","
+	  << accmap->get_min(axis) << "," << accmap->get_max(axis) << "]";
+  }
+  std::string name("accmap_" + RootAdapter::fnv1a_hex(title.str()));
+
+  // statistics are not part of the title, cached maps with fewer
+  // events than requested are rebuilt and replaced
+  TDirectory *olddir(gDirectory);
+  AcceptanceMap *cached(NULL);
+  if (not _accfile.empty() and not gSystem->AccessPathName(_accfile.c_str())) {
+    TFile *cache(TFile::Open(_accfile.c_str(), "read"));
+    if (not cache or cache->IsZombie()) {
+      ERROR("Could not open acceptance cache " << _accfile);
+    } else {
+      cached = AcceptanceMap::read(cache, name, title.str());
+      cache->Close();
+    }
+    delete cache;
+    olddir->cd();
+  }
+  if (cached and cached->get_ntried() < nevents) {
+    DEBUG("Cached acceptance map for " << title.str() << " has "
+	  << cached->get_ntried() << " < " << nevents << " events, rebuilding");
+    delete cached;
+    cached = NULL;
+  }
+
+  if (cached) {
+    DEBUG("Read acceptance map for " << title.str());
+    delete accmap;
+    accmap = cached;
+  } else {
+    // fill uniformly, so the map does not depend on the template shapes
+    std::vector<TLorentzVector> particle_lvs;
+    TLorentzVector momp;
+    for (unsigned i = 0; i < nevents; ++i) {
+      particle_lvs.clear();
+      double p(accmap->get_min(0) + gRandom->Rndm() *
+	       (accmap->get_max(0) - accmap->get_min(0)));
+      double eta(accmap->get_min(1) + gRandom->Rndm() *
+		 (accmap->get_max(1) - accmap->get_min(1)));
+      double phi(2 * M_PI * gRandom->Rndm());
+      momp.SetPtEtaPhiM(p / std::cosh(eta), eta, phi, _mommass);
+      particle_lvs.push_back(momp);
+      accmap->fill(p, eta, this->generate(momp, particle_lvs, chQ,
+					  _full_accept, _early_reject) > 0);
+    }
+    DEBUG("Built acceptance map for " << title.str() << " from "
+	  << nevents << " events");
+    if (not _accfile.empty()) {
+      TFile *cache(TFile::Open(_accfile.c_str(), "update"));
+      if (not cache or cache->IsZombie()) {
+	ERROR("Could not open acceptance cache " << _accfile);
+      } else {
+	accmap->write(cache, name, title.str());
+	cache->Close();
+      }
+      delete cache;
+      olddir->cd();
+    }
+  }
+
+  return accmap;
+}
+
+
+double TwoBodyDecayGen::predict_efficiency(TH1 *hmomp, TH1 *hmomn,
+					   unsigned nevents)
+{
+  if (not (hmomp and hmomn)) {
+    ERROR("Both mother p and η templates are needed.");
+    return -1.0;
+  }
+
+  std::vector<std::deque<chBFpair> > brfrVec;
+  std::deque<chBFpair> brfrQ;
+  this->find_leaf_nodes(brfrVec, brfrQ);
+
+  double efficiency(0.0);
+  BOOST_FOREACH(std::deque<chBFpair> chQ, brfrVec) {
+    double eff_brfr(1.0);
+    BOOST_FOREACH(chBFpair ch, chQ) {
+      eff_brfr *= ch.second;
+    }
+    AcceptanceMap *accmap(get_acceptance_map(chQ, hmomp, hmomn, nevents));
+    double eff(accmap->get_efficiency(hmomp, hmomn));
+    DEBUG("Effective BF: " << eff_brfr << ", efficiency: " << eff);
+    efficiency += eff_brfr * eff;
+    delete accmap;
+  }
+  return efficiency;
+}
+
+
+unsigned long TwoBodyDecayGen::_fill_channel(TTree *tree,
+					    std::deque<chBFpair> chQ,
+					    unsigned nevents, TH1 *hmomp,
+					    TH1 *hmomn,
+					    std::vector<TLorentzVector> &particle_lvs,
+					    double &evt_wt, double &is_wt)
+{
+  TLorentzVector momp(0.0, 0.0, 4.0, _mommass);
+
+  // learn acceptance vs mother kinematics to bias sampling towards it
+  AcceptanceMap *accmap(NULL);
+  if (_npilot > 0 and hmomn) {
+    accmap = get_acceptance_map(chQ, hmomp, hmomn, _npilot);
+    if (not accmap->build_sampler(hmomp, hmomn, _is_floor)) {
+      WARNING("Falling back to sampling from the templates.");
+      delete accmap;
+      accmap = NULL;
+    }
+  }
+
+  unsigned evt(0);
+  unsigned long ntried(0);
+  while (evt < nevents) {
+    particle_lvs.clear();
+    ntried++;
+
+    // generate event and fill tree
+    if (hmomn) {
+      double eta(0.0), p(0.0);
+      if (accmap) {
+	is_wt = accmap->sample(p, eta);
+      } else {
+	eta = hmomn->GetRandom();
+      }
+      // cheap pre-selection, before sampling anything else
+      if (_cut_mother_eta and
+	  (eta < _mother_eta[0] or _mother_eta[1] < eta)) {
+	continue;
+      }
+      if (not accmap) p = hmomp->GetRandom();
+      double pt(p / std::cosh(eta));
+      double phi(2 * M_PI * gRandom->Rndm());	// get random ∈ [0, 2π)
+      momp.SetPtEtaPhiM( pt, eta, phi, _mommass);
+    } else {
+      if (_cut_mother_eta and not _eta_warned) {
+	WARNING("No mother η template, the mother η range is not applied.");
+	_eta_warned = true;
+      }
+      momp.SetXYZM( 0.0, 0.0, hmomp->GetRandom(), _mommass);
+    }
+    particle_lvs.push_back(momp);
+    evt_wt = this->generate(momp, particle_lvs, chQ, _full_accept,
+			    _early_reject);
+    if (evt_wt <= 0) {
+      // WARNING("Decay not permitted by kinematics, skipping!");
+      continue;
+    }
+    tree->Fill();
+    evt++;
+  } // end of loop over events per leaf branch/decay node
+  DEBUG("Tried: " << ntried << ", accepted: " << evt);
+  delete accmap;
+  return ntried;
 }
 
 
 TTree* TwoBodyDecayGen::get_event_tree(unsigned nevents, TH1 *hmomp, TH1 *hmomn)
 {
   std::vector<TLorentzVector> particle_lvs;
-  double evt_wt(1.0);
+  double evt_wt(1.0), is_wt(1.0);
+  UInt_t chid(0);
 
   TTree *decaytree =
     new TTree("TwoBodyDecayGen_decaytree", "Vector of decay product "
 	      "TLorentzVectors");
   decaytree->Branch("particle_lvs", &particle_lvs);
   decaytree->Branch("evt_wt", &evt_wt, "evt_wt/D");
+  decaytree->Branch("is_wt", &is_wt, "is_wt/D");
+  decaytree->Branch("chid", &chid, "chid/i");
 
   // Reset gRandom to TRandom3
   gRandom = new TRandom3();
   std::cout << "Generating " << nevents << " events." << std::endl;
 
-  TLorentzVector momp(0.0, 0.0, 4.0, _mommass);
-
   std::vector<std::deque<chBFpair> > brfrVec;
   std::deque<chBFpair> brfrQ;
   this->find_leaf_nodes(brfrVec, brfrQ);
 
+  std::vector<Long64_t> first;
   BOOST_FOREACH(std::deque<chBFpair> chQ, brfrVec) {
+    first.push_back(decaytree->GetEntries());
     double eff_brfr(1.0);
     unsigned eff_nevents(0);
     BOOST_FOREACH(chBFpair ch, chQ) {
@@ -352,35 +631,293 @@ TTree* TwoBodyDecayGen::get_event_tree(unsigned nevents, TH1 *hmomp, TH1 *hmomn)
     }
     eff_nevents = eff_brfr * nevents;
     DEBUG("Effective BF: " << eff_brfr << ", effective events: " << eff_nevents);
+    _fill_channel(decaytree, chQ, eff_nevents, hmomp, hmomn, particle_lvs,
+		  evt_wt, is_wt);
+    chid++;
+  }   // end of loop over leaves
+
+  _add_channel_index(decaytree, brfrVec, first);
+  return decaytree;
+}
+
+
+void TwoBodyDecayGen::_add_channel_index(TTree *events,
+					 std::vector<std::deque<chBFpair> > &brfrVec,
+					 std::vector<Long64_t> &first)
+{
+  UInt_t chid(0);
+  char path[256];
+  Long64_t entry(0), nentries(0);
+
+  TTree *index = new TTree("channel_index", "Entry ranges of leaf branches");
+  index->SetDirectory(NULL);	// owned by the event tree
+  index->Branch("chid", &chid, "chid/i");
+  index->Branch("path", path, "path/C");
+  index->Branch("first", &entry, "first/L");
+  index->Branch("nentries", &nentries, "nentries/L");
+
+  for (chid = 0; chid < brfrVec.size(); ++chid) {
+    std::string chpath(get_channel_path(brfrVec[chid]));
+    chpath.copy(path, sizeof(path) - 1);
+    path[std::min(chpath.size(), sizeof(path) - 1)] = '\0';
+    entry = first[chid];
+    nentries = (chid + 1 < first.size() ? first[chid + 1] :
+		events->GetEntries()) - entry;
+    index->Fill();
+  }
+  events->GetUserInfo()->Add(index);
+  return;
+}
+
+
+TTree* TwoBodyDecayGen::get_channel_index(TTree *events)
+{
+  return dynamic_cast<TTree*>(events->GetUserInfo()->
+			      FindObject("channel_index"));
+}
+
+
+bool TwoBodyDecayGen::get_channel_entries(TTree *events, unsigned chid,
+					  Long64_t &first, Long64_t &nentries)
+{
+  TTree *index(get_channel_index(events));
+  if (not index or chid >= index->GetEntries()) return false;
+
+  index->SetBranchAddress("first", &first);
+  index->SetBranchAddress("nentries", &nentries);
+  index->GetEntry(chid);	// one entry per leaf branch, in order
+  index->ResetBranchAddresses();
+  return true;
+}
+
+
+TEntryList* TwoBodyDecayGen::get_balanced_entries(TTree *events,
+						  Long64_t nperchannel)
+{
+  TTree *index(get_channel_index(events));
+  if (not index) return NULL;
+
+  TEntryList *entries = new TEntryList("balanced_entries",
+				       "Same number of events per channel",
+				       events);
+  Long64_t first(0), nentries(0);
+  for (unsigned chid = 0; chid < index->GetEntries(); ++chid) {
+    get_channel_entries(events, chid, first, nentries);
+    for (Long64_t entry = first;
+	 entry < first + std::min(nentries, nperchannel); ++entry) {
+      entries->Enter(entry);
+    }
+  }
+  return entries;
+}
+
+
+std::string TwoBodyDecayGen::get_channel_path(std::deque<chBFpair> chQ)
+{
+  std::ostringstream path;
+  path << "[";
+  for (unsigned i = 0; i < chQ.size(); ++i) {
+    if (i > 0) path << ",";
+    path << chQ[i].first;
+  }
+  path << "]";
+  return path.str();
+}
 
-    unsigned evt(0);
-    while (evt < eff_nevents) {
-      particle_lvs.clear();
 
-      // generate event and fill tree
-      if (hmomn) {
-	double eta(hmomn->GetRandom());
-	double pt(hmomp->GetRandom() / std::cosh(eta));
-	double phi(2 * M_PI * gRandom->Rndm());	// get random ∈ [0, 2π)
-	momp.SetPtEtaPhiM( pt, eta, phi, _mommass);
+std::string TwoBodyDecayGen::_get_pool_title(std::deque<chBFpair> chQ,
+					     TH1 *hmomp, TH1 *hmomn)
+{
+  // BFs are left out, pools are reused when they change; template
+  // names are not unique, so their contents are hashed as well
+  std::ostringstream title;
+  title << get_channel_path(chQ) << " " << get_channel_key(chQ) << " "
+	<< get_acceptance_key(_full_accept);
+  TH1 *templates[2] = {hmomp, hmomn};
+  for (unsigned i = 0; i < 2; ++i) {
+    if (not templates[i]) continue;
+    title << (i ? " eta:" : " p:") << templates[i]->GetName() << "["
+	  << templates[i]->GetNbinsX() << ","
+	  << templates[i]->GetXaxis()->GetXmin() << ","
+	  << templates[i]->GetXaxis()->GetXmax() << ","
+	  << RootAdapter::template_hash(templates[i]) << "]";
+  }
+  // same condition as in _fill_channel
+  if (_npilot > 0 and hmomn) {
+    title << " is(" << _npilot << "," << _is_floor << ")";
+  }
+  return title.str();
+}
+
+
+bool TwoBodyDecayGen::write_event_pools(std::string fname, unsigned nevents,
+					TH1 *hmomp, TH1 *hmomn)
+{
+  TDirectory *olddir(gDirectory);
+  TFile *poolfile(TFile::Open(fname.c_str(), "update"));
+  if (not poolfile or poolfile->IsZombie()) {
+    ERROR("Could not open event pool file " << fname);
+    delete poolfile;
+    olddir->cd();
+    return false;
+  }
+
+  std::vector<TLorentzVector> particle_lvs;
+  double evt_wt(1.0), is_wt(1.0);
+
+  // Reset gRandom to TRandom3
+  gRandom = new TRandom3();
+
+  std::vector<std::deque<chBFpair> > brfrVec;
+  std::deque<chBFpair> brfrQ;
+  this->find_leaf_nodes(brfrVec, brfrQ);
+
+  BOOST_FOREACH(std::deque<chBFpair> chQ, brfrVec) {
+    std::string title(_get_pool_title(chQ, hmomp, hmomn));
+    std::string name("pool_" + RootAdapter::fnv1a_hex(title));
+    std::cout << "Generating " << nevents << " events for channel "
+	      << get_channel_path(chQ) << "." << std::endl;
+
+    poolfile->cd();
+    TTree pool(name.c_str(), title.c_str());
+    pool.Branch("particle_lvs", &particle_lvs);
+    pool.Branch("evt_wt", &evt_wt, "evt_wt/D");
+    pool.Branch("is_wt", &is_wt, "is_wt/D");
+    _fill_channel(&pool, chQ, nevents, hmomp, hmomn, particle_lvs,
+		  evt_wt, is_wt);
+    pool.Write(NULL, TObject::kOverwrite);
+  }
+
+  poolfile->Close();
+  delete poolfile;
+  olddir->cd();
+  return true;
+}
+
+
+TTree* TwoBodyDecayGen::get_event_mixture(std::string fname, unsigned nevents,
+					  TH1 *hmomp, TH1 *hmomn,
+					  bool subsample)
+{
+  std::vector<TLorentzVector> particle_lvs, *pool_lvs(NULL);
+  double evt_wt(1.0), is_wt(1.0), bf_wt(1.0);
+  UInt_t chid(0);
+
+  TTree *decaytree =
+    new TTree("TwoBodyDecayGen_decaytree", "Vector of decay product "
+	      "TLorentzVectors");
+  decaytree->Branch("particle_lvs", &particle_lvs);
+  decaytree->Branch("evt_wt", &evt_wt, "evt_wt/D");
+  decaytree->Branch("is_wt", &is_wt, "is_wt/D");
+  decaytree->Branch("bf_wt", &bf_wt, "bf_wt/D");
+  decaytree->Branch("chid", &chid, "chid/i");
+
+  TDirectory *olddir(gDirectory);
+  TFile *poolfile(TFile::Open(fname.c_str(), "read"));
+  if (not poolfile or poolfile->IsZombie()) {
+    ERROR("Could not open event pool file " << fname);
+    delete poolfile;
+    olddir->cd();
+    delete decaytree;
+    return NULL;
+  }
+
+  std::vector<std::deque<chBFpair> > brfrVec;
+  std::deque<chBFpair> brfrQ;
+  this->find_leaf_nodes(brfrVec, brfrQ);
+
+  bool status(true);
+  std::vector<Long64_t> first;
+  BOOST_FOREACH(std::deque<chBFpair> chQ, brfrVec) {
+    first.push_back(decaytree->GetEntries());
+    double eff_brfr(1.0);
+    BOOST_FOREACH(chBFpair ch, chQ) {
+      eff_brfr *= ch.second;
+    }
+    unsigned eff_nevents(eff_brfr * nevents);
+
+    std::string title(_get_pool_title(chQ, hmomp, hmomn));
+    std::string name("pool_" + RootAdapter::fnv1a_hex(title));
+    TTree *pool(dynamic_cast<TTree*>(poolfile->Get(name.c_str())));
+    if (not pool or title != pool->GetTitle()) {
+      ERROR("No event pool for " << title);
+      status = false;
+      break;
+    }
+
+    // pool events are independent, the first ones are a random subsample
+    unsigned npool(pool->GetEntries()), nread(npool);
+    if (subsample) {
+      if (npool < eff_nevents) {
+	WARNING("Event pool for channel " << get_channel_path(chQ) << " has "
+		<< npool << " < " << eff_nevents << " events, using all.");
       } else {
-	momp.SetXYZM( 0.0, 0.0, hmomp->GetRandom(), _mommass);
-      }
-      particle_lvs.push_back(momp);
-      evt_wt = this->generate(momp, particle_lvs, chQ);
-      if (evt_wt <= 0) {
-	// WARNING("Decay not permitted by kinematics, skipping!");
-	continue;
+	nread = eff_nevents;
       }
+    }
+    bf_wt = nread > 0 ? double(eff_nevents) / nread : 0.0;
+    DEBUG("Effective BF: " << eff_brfr << ", pool events: " << npool
+	  << ", used: " << nread << ", weight: " << bf_wt);
+
+    pool->SetBranchAddress("particle_lvs", &pool_lvs);
+    pool->SetBranchAddress("evt_wt", &evt_wt);
+    pool->SetBranchAddress("is_wt", &is_wt);
+    for (unsigned evt = 0; evt < nread; ++evt) {
+      pool->GetEntry(evt);
+      particle_lvs = *pool_lvs;
       decaytree->Fill();
-      evt++;
-    } // end of loop over events per leaf branch/decay node
-  }   // end of loop over leaves
+    }
+    pool->ResetBranchAddresses();
+    delete pool;
+    chid++;
+  }
 
+  poolfile->Close();
+  delete poolfile;
+  delete pool_lvs;
+  olddir->cd();
+
+  if (not status) {
+    delete decaytree;
+    return NULL;
+  }
+  _add_channel_index(decaytree, brfrVec, first);
   return decaytree;
 }
 
 
+unsigned TwoBodyDecayGen::_count_daughters(std::deque<chBFpair> chQ)
+{
+  if (chQ.empty()) return NDAUS; // at leaf node
+
+  // same traversal as generate
+  unsigned ich(chQ.front().first);
+  chQ.pop_front();
+
+  unsigned ndaus(NDAUS);
+  for (unsigned j = 0; j < NDAUS; ++j) {
+    if (_dauchannels[ich].first[j]) {
+      ndaus += _dauchannels[ich].first[j]->_count_daughters(chQ);
+    }
+  }
+  return ndaus;
+}
+
+
+unsigned TwoBodyDecayGen::get_nparticles()
+{
+  std::vector<std::deque<chBFpair> > brfrVec;
+  std::deque<chBFpair> brfrQ;
+  this->find_leaf_nodes(brfrVec, brfrQ);
+
+  unsigned nparticles(0);
+  BOOST_FOREACH(std::deque<chBFpair> chQ, brfrVec) {
+    nparticles = std::max(nparticles, get_nparticles(chQ));
+  }
+  return nparticles;
+}
+
+
 void TwoBodyDecayGen::print(unsigned indent) {
   std::string prefix(indent * 2, ' ');
   std::cout << prefix << "mommass: " << _mommass << ", daumass: ("
@@ -19,10 +19,14 @@
 // ROOT headers
 #include <TH1.h>
 #include <TTree.h>
+#include <TEntryList.h>
 #include <TLorentzVector.h>
 #include <TGenPhaseSpace.h>
 
-#define NDAUS 2			/**< Number of daughters, fixed to 2 */
+// package headers
+#include "DecayKinematics.hxx"
+
+class AcceptanceMap;
 
 
 /**
@@ -30,15 +34,16 @@
  * events using the ROOT class TGenPhaseSpace.
  *
  * Note that this is a very simple phase space event generator and is
- * not aware of any resonances.  The decay tree is stored as an array
- * with particle masses and pointers to TwoBodyDecayGen instances for
- * subsequent decay vertices.  These pointers are NULL for leaf nodes
- * in the decay tree.  There are several constructors to instantiate a
- * TwoBodyDecayGen object; use of the constructor which takes an array
- * with particle masses and length of the decay tree (also the length
- * of the particle mass array) is recommended for simplicity of use.
- * Look at the constructor documentation for more details on the
- * format.
+ * not aware of any resonances (DecayGenCore::add_line_shape samples
+ * resonance masses in the ROOT independent core).  The decay tree is
+ * stored as an array with particle masses and pointers to
+ * TwoBodyDecayGen instances for subsequent decay vertices.  These
+ * pointers are NULL for leaf nodes in the decay tree.  There are
+ * several constructors to instantiate a TwoBodyDecayGen object; use
+ * of the constructor which takes an array with particle masses and
+ * length of the decay tree (also the length of the particle mass
+ * array) is recommended for simplicity of use.  Look at the
+ * constructor documentation for more details on the format.
  *
  * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
  * @date 2012-11-05 Mon
@@ -134,6 +139,20 @@ public:
    */
   double get_brfr(unsigned chid);
 
+  /**
+   * Change BF of a decay channel
+   *
+   * As in add_decay_channel, the BF of the primary channel (0) is
+   * adjusted so that the BFs add up to 1, so it cannot be set
+   * directly.  Used to scan BFs with get_event_mixture.
+   *
+   * @param chid Decay channel id (> 0)
+   * @param brfr New branching fraction
+   *
+   * @return Status
+   */
+  bool set_brfr(unsigned chid, double brfr);
+
   /**
    * Find leaf branches or decay nodes.
    *
@@ -164,6 +183,12 @@ public:
    * <b>NB:</b> end points (d{2..4} @ L1 or d{1,2} @ L0) are stored as
    * NULL pointers
    *
+   * <b>NB:</b> only single-chain trees give one complete branch per
+   * channel.  If both daughters of a vertex decay, each leaf node
+   * gives its own, shorter branch (e.g. [[(0,1)], []] for a mother
+   * whose daughters both decay to final-state particles), and only
+   * the longest branch decays every vertex when passed to generate.
+   *
    * @param brfrVec Vector with deque for each leaf branch / decay node
    * @param brfrQ Pointer to deque for each leaf branch / decay node
    *
@@ -175,15 +200,25 @@ public:
   /**
    * Generate one event at a time
    *
+   * When full is true, every final-state daughter has to be inside
+   * the LHCb acceptance, otherwise the second daughter of each leaf
+   * node (see set_full_acceptance).  When early is true, the event is
+   * rejected at the first particle outside the acceptance, before
+   * descending further down the decay tree; otherwise the whole tree
+   * is decayed first.
+   *
    * @param momp Mother 4-momentum
    * @param particle_lvs std::vector used to return generated 4-momenta
    * @param chQ Queue with channels to generate
+   * @param full Require all final-state particles in acceptance
+   * @param early Reject on the first particle outside acceptance
    *
-   * @return Event weight
+   * @return Event weight (-100 if outside acceptance)
    */
   double generate(TLorentzVector &momp,
 		  std::vector<TLorentzVector> &particle_lvs,
-		  std::deque<chBFpair> chQ);
+		  std::deque<chBFpair> chQ, bool full=false,
+		  bool early=false);
 
   /**
    * Return if the particle is in LHCb detector acceptance
@@ -194,9 +229,170 @@ public:
    */
   bool lv_in_LHCb(TLorentzVector &part_lv);
 
+  /**
+   * Choose the acceptance definition
+   *
+   * By default an event is accepted if the second daughter of each
+   * leaf node is inside the LHCb acceptance.  With the full
+   * definition <i>all</i> final-state particles have to be inside.
+   * The definition is part of the acceptance map and pool keys.
+   *
+   * @param full Require all final-state particles in acceptance
+   */
+  void set_full_acceptance(bool full=true);
+
+  /**
+   * Return if all final-state particles have to be in acceptance
+   *
+   * @return Full acceptance definition
+   */
+  bool get_full_acceptance() const { return _full_accept; }
+
+  /**
+   * Enable or disable early rejection
+   *
+   * With early rejection, get_event_tree checks each particle of the
+   * acceptance definition (see set_full_acceptance) as soon as its
+   * momentum is known and stops the event immediately, instead of
+   * decaying the full tree first.  This only saves time: the same
+   * events are accepted, but fewer random numbers are drawn for
+   * rejected ones.
+   *
+   * @param early Use early rejection
+   */
+  void set_early_rejection(bool early=true);
+
+  /**
+   * Return if early rejection is enabled
+   *
+   * @return Early rejection
+   */
+  bool get_early_rejection() const { return _early_reject; }
+
+  /**
+   * Reject mothers outside a pseudorapidity range before decaying
+   *
+   * This is a cheap pre-selection on the mother particle applied
+   * before the decay is generated.  It is the responsibility of the
+   * user to choose a range wide enough to be a necessary condition
+   * for the daughters to be in acceptance.  It needs the mother η
+   * template; without one the range is not applied, and a warning is
+   * printed (once).  Acceptance maps are filled without it.
+   *
+   * @param etalo Lower bound on mother η
+   * @param etahi Upper bound on mother η
+   */
+  void set_mother_eta_range(double etalo, double etahi);
+
+  /**
+   * Sample mother 4-momentum from templates
+   *
+   * Same as get_event_tree without importance sampling: the momentum
+   * is along the z-axis if no η template is given.  Uses gRandom.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param momp Returns mother 4-momentum
+   *
+   * @return False if rejected by the mother η range
+   */
+  bool sample_mother(TH1 *hmomp, TH1 *hmomn, TLorentzVector &momp);
+
+  /**
+   * Enable importance sampling of the mother kinematics
+   *
+   * For every decay channel, a pilot run of npilot events is used to
+   * estimate the acceptance efficiency as a function of mother p and
+   * η (see get_acceptance_map).  Mothers are then sampled from the
+   * templates multiplied by this efficiency, raising the fraction of
+   * accepted events.  The correcting weight of each event is stored
+   * in the is_wt branch of the event tree, normalised per channel to
+   * a mean of 1 over accepted events (see
+   * AcceptanceMap::build_sampler), so the is_wt weighted mixture of
+   * all channels keeps the branching fractions.  Requires the mother
+   * η template, with uniform binning like the p template.  Pass
+   * npilot = 0 to disable.  If an acceptance cache is set, maps are
+   * read from there instead of running the pilot.
+   *
+   * @param npilot Number of pilot events per decay channel
+   * @param floor Minimum efficiency used for sampling, relative to the maximum
+   */
+  void set_importance_sampling(unsigned npilot, double floor=0.01);
+
+  /**
+   * Use a ROOT file to cache acceptance maps between runs
+   *
+   * Maps built by get_acceptance_map are saved to this file, and
+   * read back instead of being rebuilt when the decay channel,
+   * acceptance and template binning match, and the saved map has at
+   * least the requested statistics.  The file is only opened for
+   * writing when a map is saved.
+   *
+   * @param fname ROOT file name (created if it does not exist)
+   */
+  void set_acceptance_cache(std::string fname);
+
+  /**
+   * Return a key describing the particle masses of a decay channel
+   *
+   * @param chQ Queue with channels to generate (from find_leaf_nodes)
+   *
+   * @return Key, e.g. "5.3663>(2.11234>(1.96849,0),0.13957)"
+   */
+  std::string get_channel_key(std::deque<chBFpair> chQ);
+
+  /**
+   * Return a key describing the acceptance definition
+   *
+   * @param full Full acceptance definition (all final-state particles)
+   *
+   * @return Key
+   */
+  static std::string get_acceptance_key(bool full);
+
+  /**
+   * Return acceptance map for a decay channel
+   *
+   * The map is read from the acceptance cache if available and
+   * built from at least nevents events, otherwise it is filled with
+   * nevents events generated uniformly in the mother p and η ranges
+   * of the templates (and saved to the cache, replacing a map with
+   * fewer events).
+   *
+   * @param chQ Queue with channels to generate (from find_leaf_nodes)
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param nevents Number of events used to build the map
+   *
+   * @return New acceptance map (owned by the caller)
+   */
+  AcceptanceMap* get_acceptance_map(std::deque<chBFpair> chQ, TH1 *hmomp,
+				    TH1 *hmomn, unsigned nevents);
+
+  /**
+   * Predict acceptance efficiency from the acceptance maps
+   *
+   * The efficiency of each decay channel is averaged over the
+   * templates and summed weighted with the channel branching
+   * fraction.  With a filled acceptance cache nothing is generated.
+   *
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param nevents Number of events used to build missing maps
+   *
+   * @return Fraction of generated events inside the acceptance (-ve on error)
+   */
+  double predict_efficiency(TH1 *hmomp, TH1 *hmomn, unsigned nevents);
+
   /**
    * Generate arbitrary number of events
    *
+   * Events of each leaf branch (see find_leaf_nodes) are generated
+   * in one block.  The leaf branch is stored per event in the chid
+   * branch (its position in find_leaf_nodes order), and the entry
+   * range of each leaf branch in a channel index saved with the tree
+   * (see get_channel_index).
+   *
    * @param nevents Number of events to generate
    * @param hmomp Template histogram for 3-momentum of the mother particle
    * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
@@ -205,6 +401,124 @@ public:
    */
   TTree* get_event_tree(unsigned nevents, TH1 *hmomp, TH1 *hmomn=NULL);
 
+  /**
+   * Return the channel index of an event tree
+   *
+   * The index is a small tree in the user info of the event tree,
+   * with one entry per leaf branch: chid, path (see
+   * get_channel_path), first entry and number of entries.  It is
+   * written and read together with the event tree.
+   *
+   * @param events Event tree (from get_event_tree or get_event_mixture)
+   *
+   * @return Channel index (owned by the event tree, NULL if missing)
+   */
+  static TTree* get_channel_index(TTree *events);
+
+  /**
+   * Return the entry range of a leaf branch in an event tree
+   *
+   * @param events Event tree (from get_event_tree or get_event_mixture)
+   * @param chid Leaf branch id (chid branch)
+   * @param first Returns first entry
+   * @param nentries Returns number of entries
+   *
+   * @return False if the tree has no index or no such leaf branch
+   */
+  static bool get_channel_entries(TTree *events, unsigned chid,
+				  Long64_t &first, Long64_t &nentries);
+
+  /**
+   * Select the same number of events from every leaf branch
+   *
+   * Events are independent, so the first entries of each leaf branch
+   * are a random subsample.  Leaf branches with fewer events are used
+   * completely.  Use with TTree::SetEntryList.
+   *
+   * @param events Event tree (from get_event_tree or get_event_mixture)
+   * @param nperchannel Number of events per leaf branch
+   *
+   * @return Entry list (owned by the caller, NULL if the tree has no index)
+   */
+  static TEntryList* get_balanced_entries(TTree *events,
+					  Long64_t nperchannel);
+
+  /**
+   * Return the channel ids along a leaf branch as a string
+   *
+   * @param chQ Queue with channels to generate (from find_leaf_nodes)
+   *
+   * @return Channel path, e.g. "[1,0]"
+   */
+  static std::string get_channel_path(std::deque<chBFpair> chQ);
+
+  /**
+   * Generate and save an event pool for every leaf branch
+   *
+   * Each leaf branch (see find_leaf_nodes) gets nevents accepted
+   * events, irrespective of its branching fraction.  Pools are saved
+   * as trees with the same branches as the event tree, tagged with
+   * the channel path, particle masses, acceptance, templates (binning
+   * and a hash of the contents) and importance sampling settings.
+   * Existing pools with the same tag are replaced.
+   *
+   * @param fname ROOT file name (created if it does not exist)
+   * @param nevents Number of events per leaf branch
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   *
+   * @return Status
+   */
+  bool write_event_pools(std::string fname, unsigned nevents, TH1 *hmomp,
+			 TH1 *hmomn=NULL);
+
+  /**
+   * Make an event tree for the current BFs from saved event pools
+   *
+   * Nothing is generated, so BFs can be changed (set_brfr) and the
+   * mixture remade quickly.  With subsampling, the first
+   * eff_brfr*nevents events of each pool are used, as get_event_tree
+   * would generate them; otherwise all pool events are used and
+   * weighted by eff_brfr*nevents/npool.  The weight is stored in the
+   * additional bf_wt branch (1 when subsampling from large enough
+   * pools).  The templates are only used to find the pools.
+   *
+   * @param fname ROOT file with event pools (see write_event_pools)
+   * @param nevents Number of events
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param subsample Subsample the pools instead of weighting
+   *
+   * @return Event tree (NULL if a pool is missing)
+   */
+  TTree* get_event_mixture(std::string fname, unsigned nevents, TH1 *hmomp,
+			   TH1 *hmomn=NULL, bool subsample=true);
+
+  /**
+   * Return number of particles in the largest decay channel
+   *
+   * This includes the mother, and is the length of the particle_lvs
+   * vector filled by get_event_tree for that channel.
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles();
+
+  /**
+   * Return number of particles generated for a leaf branch
+   *
+   * This includes the mother.  A branch from find_leaf_nodes does not
+   * always decay the whole tree (see DecayGenCore).
+   *
+   * @param chQ Queue with channels to generate
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles(std::deque<chBFpair> chQ)
+  {
+    return 1 + _count_daughters(chQ);
+  }
+
   /**
    * Print decay tree
    *
@@ -214,6 +528,48 @@ public:
 
 private:
 
+  /**
+   * Generate events of one leaf branch into a tree
+   *
+   * The tree branches have to point to the variables passed.
+   *
+   * @param tree Tree to fill
+   * @param chQ Queue with channels to generate
+   * @param nevents Number of accepted events
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   * @param particle_lvs Generated 4-momenta
+   * @param evt_wt Event weight
+   * @param is_wt Importance sampling weight
+   *
+   * @return Number of tried events
+   */
+  unsigned long _fill_channel(TTree *tree, std::deque<chBFpair> chQ,
+			      unsigned nevents, TH1 *hmomp, TH1 *hmomn,
+			      std::vector<TLorentzVector> &particle_lvs,
+			      double &evt_wt, double &is_wt);
+
+  /**
+   * Return the tag of an event pool
+   *
+   * @param chQ Queue with channels to generate
+   * @param hmomp Template histogram for 3-momentum of the mother particle
+   * @param hmomn Template histogram for pseudorapidity(η) of the mother particle
+   *
+   * @return Pool title
+   */
+  std::string _get_pool_title(std::deque<chBFpair> chQ, TH1 *hmomp,
+			      TH1 *hmomn);
+
+  /**
+   * Count the particles produced for a decay channel (excluding mother)
+   *
+   * @param chQ Queue with channels to generate
+   *
+   * @return Number of particles
+   */
+  unsigned _count_daughters(std::deque<chBFpair> chQ);
+
   /**
    * Print queue for debugging
    *
@@ -230,7 +586,26 @@ private:
    */
   void _printQ(std::string prefix, std::vector<std::deque<chBFpair> > queue);
 
+  /**
+   * Save the channel index in the user info of an event tree
+   *
+   * @param events Event tree
+   * @param brfrVec Leaf branches (from find_leaf_nodes)
+   * @param first First entry of each leaf branch
+   */
+  static void _add_channel_index(TTree *events,
+				 std::vector<std::deque<chBFpair> > &brfrVec,
+				 std::vector<Long64_t> &first);
+
   static unsigned long long _count; /**< Debug message counter */
+  bool _full_accept;		/**< All final-state particles in acceptance */
+  bool _early_reject;		/**< Reject events as early as possible */
+  bool _cut_mother_eta;		/**< Apply mother η range before decaying */
+  bool _eta_warned;		/**< Warned that the η range is not applied */
+  double _mother_eta[2];	/**< Allowed mother η range */
+  unsigned _npilot;		/**< Pilot events for importance sampling */
+  double _is_floor;		/**< Efficiency floor for importance sampling */
+  std::string _accfile;		/**< Acceptance map cache file */
   TGenPhaseSpace _generator;	/**< Generator for the current decay vertex */
   double _mommass;		/**< Mother particle mass for the current decay vertex */
   double _daumasses[NDAUS];	/**< Array of the two daughter masses */
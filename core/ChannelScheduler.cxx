@@ -0,0 +1,123 @@
+/**
+ * @file   ChannelScheduler.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Fri Oct 23 10:47:19 2026
+ *
+ * @brief  Implementation of ChannelScheduler
+ *
+ *
+ */
+
+// STL headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// package headers
+#include "ChannelScheduler.hxx"
+
+
+ChannelScheduler::ChannelScheduler(unsigned nworkers) :
+  _nextqueue(0), _nchunks(0), _nstolen(0)
+{
+  if (nworkers < 1) nworkers = 1;
+  for (unsigned i = 0; i < nworkers; ++i) {
+    _queues.push_back(new WorkQueue());
+  }
+}
+
+
+ChannelScheduler::~ChannelScheduler()
+{
+  for (unsigned i = 0; i < _queues.size(); ++i) {
+    delete _queues[i];
+  }
+}
+
+
+void ChannelScheduler::add_channel(unsigned chid, unsigned long nevents,
+				   unsigned long chunksize)
+{
+  if (chunksize < 1) chunksize = 1;
+  if (_stats.size() <= chid) {
+    ChannelStats stats = {0, 0, 0, 0.0};
+    _stats.resize(chid + 1, stats);
+  }
+
+  // deal chunks round-robin, so every worker starts with a mix of channels
+  while (nevents > 0) {
+    Chunk chunk = {chid, std::min(nevents, chunksize), _nchunks++};
+    nevents -= chunk.nevents;
+
+    WorkQueue *queue(_queues[_nextqueue]);
+    _nextqueue = (_nextqueue + 1) % _queues.size();
+    boost::mutex::scoped_lock lock(queue->mutex);
+    queue->chunks.push_back(chunk);
+  }
+  return;
+}
+
+
+bool ChannelScheduler::next(unsigned worker, Chunk &chunk)
+{
+  { // own queue
+    WorkQueue *queue(_queues[worker]);
+    boost::mutex::scoped_lock lock(queue->mutex);
+    if (not queue->chunks.empty()) {
+      chunk = queue->chunks.front();
+      queue->chunks.pop_front();
+      return true;
+    }
+  }
+
+  // steal from the back of the others, starting with the next worker
+  for (unsigned i = 1; i < _queues.size(); ++i) {
+    WorkQueue *queue(_queues[(worker + i) % _queues.size()]);
+    boost::mutex::scoped_lock lock(queue->mutex);
+    if (not queue->chunks.empty()) {
+      chunk = queue->chunks.back();
+      queue->chunks.pop_back();
+      lock.unlock();
+
+      boost::mutex::scoped_lock statslock(_statsmutex);
+      _nstolen++;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void ChannelScheduler::report(const Chunk &chunk, unsigned long ntried,
+			      double walltime)
+{
+  boost::mutex::scoped_lock lock(_statsmutex);
+  ChannelStats &stats(_stats[chunk.chid]);
+  stats.ntried += ntried;
+  stats.naccepted += chunk.nevents;
+  stats.nchunks++;
+  stats.walltime += walltime;
+  return;
+}
+
+
+void ChannelScheduler::print_stats() const
+{
+  std::cout << std::setw(8) << "channel" << std::setw(12) << "accepted"
+	    << std::setw(12) << "tried" << std::setw(12) << "eff."
+	    << std::setw(12) << "time [s]" << std::setw(14) << "µs/accepted"
+	    << std::endl;
+  for (unsigned chid = 0; chid < _stats.size(); ++chid) {
+    const ChannelStats &stats(_stats[chid]);
+    if (stats.nchunks == 0) continue;
+    std::cout << std::setw(8) << chid << std::setw(12) << stats.naccepted
+	      << std::setw(12) << stats.ntried << std::setw(12)
+	      << std::setprecision(4)
+	      << (stats.ntried ? double(stats.naccepted) / stats.ntried : 0.0)
+	      << std::setw(12) << stats.walltime << std::setw(14)
+	      << (stats.naccepted ? 1E6 * stats.walltime / stats.naccepted : 0.0)
+	      << std::endl;
+  }
+  std::cout << "Stolen chunks: " << _nstolen << std::endl;
+  return;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file   ChannelScheduler.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Fri Oct 23 10:02:44 2026
+ *
+ * @brief  Work-stealing scheduler for per-channel event budgets
+ *
+ *
+ */
+
+#ifndef CHANNELSCHEDULER_HXX
+#define CHANNELSCHEDULER_HXX
+
+// STL headers
+#include <vector>
+#include <deque>
+
+// Boost headers
+#include <boost/thread/mutex.hpp>
+#include <boost/noncopyable.hpp>
+
+
+/**
+ * This class distributes the number of events to generate for each
+ * decay channel over several workers (threads).
+ *
+ * The cost of an accepted event differs by orders of magnitude
+ * between decay channels (acceptance efficiency), so a fixed split
+ * leaves threads idle.  Instead, the budget of each channel is split
+ * into small chunks, which are dealt round-robin into one queue per
+ * worker.  A worker takes chunks from the front of its own queue, and
+ * when that is empty steals from the back of the other queues, so all
+ * workers stay busy until the last chunk is done.
+ *
+ * Workers report the wall time, tried and accepted events of each
+ * chunk, which are summed per channel (see print_stats).
+ *
+ * Which worker gets which chunk depends on timing, so workers should
+ * not keep one random number sequence for all their chunks.  Every
+ * chunk has a fixed index instead (in the order the chunks were
+ * added), from which the worker derives the seed of the chunk; the
+ * generated events then do not depend on the number of workers or on
+ * the scheduling.
+ *
+ * Only HistogramGen uses the scheduler.  TwoBodyDecayGen::get_event_tree
+ * still generates the channels one after the other on one thread,
+ * and PipelineGen chooses the channel of each event in its single
+ * sampling stage.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-23 Fri
+ *
+ */
+
+class ChannelScheduler : private boost::noncopyable {
+public:
+
+  /**
+   * Events to generate for one channel
+   */
+  struct Chunk {
+    unsigned chid;		/**< Decay channel id */
+    unsigned long nevents;	/**< Number of accepted events */
+    unsigned long index;	/**< Chunk index, in the order added (for seeds) */
+  };
+
+  /**
+   * Per channel counters
+   */
+  struct ChannelStats {
+    unsigned long ntried;	/**< Tried events */
+    unsigned long naccepted;	/**< Accepted events */
+    unsigned long nchunks;	/**< Finished chunks */
+    double walltime;		/**< Wall time summed over workers in s */
+  };
+
+  /**
+   * Constructor
+   *
+   * @param nworkers Number of workers
+   */
+  ChannelScheduler(unsigned nworkers);
+
+  ~ChannelScheduler();
+
+  /**
+   * Add the events of a decay channel
+   *
+   * @param chid Decay channel id
+   * @param nevents Number of accepted events
+   * @param chunksize Number of events per chunk
+   */
+  void add_channel(unsigned chid, unsigned long nevents,
+		   unsigned long chunksize=1000);
+
+  /**
+   * Get the next chunk for a worker
+   *
+   * @param worker Worker id
+   * @param chunk Returns the chunk
+   *
+   * @return False when there is no work left
+   */
+  bool next(unsigned worker, Chunk &chunk);
+
+  /**
+   * Report a finished chunk
+   *
+   * @param chunk Finished chunk
+   * @param ntried Tried events
+   * @param walltime Wall time in s
+   */
+  void report(const Chunk &chunk, unsigned long ntried, double walltime);
+
+  /**
+   * Return per channel counters
+   *
+   * @param chid Decay channel id
+   *
+   * @return Counters
+   */
+  const ChannelStats& get_stats(unsigned chid) const { return _stats[chid]; }
+
+  /**
+   * Return number of stolen chunks
+   *
+   * @return Stolen chunks
+   */
+  unsigned long get_nstolen() const { return _nstolen; }
+
+  /**
+   * Print per channel wall time breakdown
+   */
+  void print_stats() const;
+
+private:
+
+  /**
+   * Queue of chunks of one worker
+   */
+  struct WorkQueue {
+    boost::mutex mutex;		/**< Protects chunks */
+    std::deque<Chunk> chunks;	/**< Chunks, taken from the front */
+  };
+
+  std::vector<WorkQueue*> _queues; /**< Queue per worker */
+  unsigned _nextqueue;		   /**< Queue for the next chunk */
+  unsigned long _nchunks;	   /**< Chunks added so far */
+  boost::mutex _statsmutex;	   /**< Protects counters */
+  std::vector<ChannelStats> _stats; /**< Per channel counters */
+  unsigned long _nstolen;	   /**< Stolen chunks */
+};
+
+#endif	// CHANNELSCHEDULER_HXX
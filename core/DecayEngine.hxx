@@ -0,0 +1,151 @@
+/**
+ * @file   DecayEngine.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Thu Oct 29 10:26:41 2026
+ *
+ * @brief  Interface of event generation engines
+ *
+ *
+ */
+
+#ifndef DECAYENGINE_HXX
+#define DECAYENGINE_HXX
+
+
+// package headers
+#include "TemplateSampler.hxx"
+#include "DecayGenCore.hxx"
+
+
+/**
+ * Base class for engines that generate events of a decay tree.
+ *
+ * An engine is built from the same particle mass arrays as
+ * TwoBodyDecayGen, with its decay channels in the same order as the
+ * leaf branches of TwoBodyDecayGen::find_leaf_nodes.  Events are
+ * filled in the flat layout of DecayGenCore::generate: 4-momenta
+ * (px, py, pz, E) of the mother, followed by the two daughters of
+ * each decay vertex.  This is what EquivalenceTest compares with the
+ * reference generator, so a new engine (batched kernels, reduced
+ * precision, other random number generators) only has to implement
+ * this interface to be validated.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-29 Thu
+ *
+ */
+
+class DecayEngine {
+public:
+
+  virtual ~DecayEngine() {}
+
+  /**
+   * Return number of decay channels
+   *
+   * @return Number of channels
+   */
+  virtual unsigned get_nchannels() const = 0;
+
+  /**
+   * Return number of particles (including the mother) in a channel
+   *
+   * @param chid Decay channel id
+   *
+   * @return Number of particles
+   */
+  virtual unsigned get_nparticles(unsigned chid) const = 0;
+
+  /**
+   * Seed the random number generator
+   *
+   * @param seed Seed
+   */
+  virtual void set_seed(unsigned seed) = 0;
+
+  /**
+   * Choose the acceptance definition
+   *
+   * @param full Require all final-state particles in acceptance
+   */
+  virtual void set_full_acceptance(bool full) = 0;
+
+  /**
+   * Enable or disable early rejection
+   *
+   * @param early Use early rejection
+   */
+  virtual void set_early_rejection(bool early) = 0;
+
+  /**
+   * Sample mother 4-momentum from templates
+   *
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   * @param mother Returns mother 4-momentum
+   *
+   * @return False if the mother is rejected
+   */
+  virtual bool sample_mother(const TemplateSampler &psampler,
+			     const TemplateSampler *etasampler,
+			     double *mother) = 0;
+
+  /**
+   * Generate one event
+   *
+   * @param chid Decay channel id
+   * @param particles 4-momenta of all particles, the mother has to be set
+   *
+   * @return Event weight (≤ 0 if rejected)
+   */
+  virtual double generate(unsigned chid, double *particles) = 0;
+};
+
+
+/**
+ * DecayGenCore as a DecayEngine
+ *
+ * The generator is not owned, and is used directly everywhere else,
+ * so its per-event methods stay non-virtual.
+ */
+
+class CoreEngine : public DecayEngine {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param core Generator
+   */
+  CoreEngine(DecayGenCore &core) : _core(core) {}
+
+  unsigned get_nchannels() const { return _core.get_nchannels(); }
+
+  unsigned get_nparticles(unsigned chid) const
+  {
+    return _core.get_nparticles(chid);
+  }
+
+  void set_seed(unsigned seed) { _core.set_seed(seed); }
+
+  void set_full_acceptance(bool full) { _core.set_full_acceptance(full); }
+
+  void set_early_rejection(bool early) { _core.set_early_rejection(early); }
+
+  bool sample_mother(const TemplateSampler &psampler,
+		     const TemplateSampler *etasampler, double *mother)
+  {
+    return _core.sample_mother(psampler, etasampler, mother);
+  }
+
+  double generate(unsigned chid, double *particles)
+  {
+    return _core.generate(chid, particles);
+  }
+
+private:
+
+  DecayGenCore &_core;		/**< Generator */
+};
+
+#endif	// DECAYENGINE_HXX
@@ -0,0 +1,435 @@
+/**
+ * @file   DecayGenCore.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 14:38:51 2026
+ *
+ * @brief  Implementation of DecayGenCore
+ *
+ *
+ */
+
+// STL headers
+#include <algorithm>
+
+/**
+ * \def _USE_MATH_DEFINES
+ * Enable definitions from cmath (e.g. mathematical constants)
+ */
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+// Boost headers
+#include <boost/foreach.hpp>
+#include <boost/random/uniform_01.hpp>
+
+// package headers
+#include "DecayGenCore.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long DecayGenCore::_count(0);
+
+
+DecayGenCore::DecayGenCore(double *masses, unsigned nparts) :
+  _mommass(masses[0]), _full_accept(false), _early_reject(false),
+  _cut_mother_eta(false), _eta_warned(false), _nsampled(0), _nbelow(0)
+{
+  _daumasses[0] = masses[1];
+  _daumasses[1] = masses[2];
+
+  Channel channel;
+  channel.brfr = 1.0;
+  _add_vertices(masses, nparts, 0, channel.vertices);
+  _flag_sampled(channel.vertices);
+  _channels.push_back(channel);
+}
+
+
+void DecayGenCore::split_daughter_trees(double *masses, unsigned nparts,
+					std::vector<double> &dau1tree,
+					std::vector<double> &dau2tree)
+{
+  const unsigned nodes = (nparts - 1) / 2;
+  for (unsigned i = 1; i < nodes; ++i) {
+    if (i % 2) {
+      if (i == 1) dau1tree.push_back(masses[i]);
+      dau1tree.push_back(masses[2*i + 1]);
+      dau1tree.push_back(masses[2*i + 2]);
+    } else {
+      if (i == 2) dau2tree.push_back(masses[i]);
+      dau2tree.push_back(masses[2*i + 1]);
+      dau2tree.push_back(masses[2*i + 2]);
+    }
+  }
+  return;
+}
+
+
+void DecayGenCore::_add_vertices(double *masses, unsigned nparts,
+				 unsigned mother, std::vector<Vertex> &vertices)
+{
+  const unsigned ivtx(vertices.size());
+
+  Vertex vertex;
+  vertex.mother = mother;
+  for (unsigned j = 0; j < NDAUS; ++j) {
+    vertex.daumasses[j] = masses[j + 1];
+    vertex.decays[j] = false;
+  }
+  _assign_line_shapes(vertex);
+  vertices.push_back(vertex);
+
+  if (nparts <= 3) return;
+
+  // daughters of vertex i are particles 2i + 1 and 2i + 2
+  std::vector<double> dau1tree, dau2tree;
+  split_daughter_trees(masses, nparts, dau1tree, dau2tree);
+  if (not dau1tree.empty()) {
+    vertices[ivtx].decays[0] = true;
+    _add_vertices(&dau1tree[0], dau1tree.size(), 2*ivtx + 1, vertices);
+  }
+  if (not dau2tree.empty()) {
+    vertices[ivtx].decays[1] = true;
+    _add_vertices(&dau2tree[0], dau2tree.size(), 2*ivtx + 2, vertices);
+  }
+  return;
+}
+
+
+bool DecayGenCore::add_decay_channel(double *masses, unsigned nparts,
+				     double brfr)
+{
+  if ((std::fabs(masses[0] - _mommass) > 1E-4) or
+      (std::fabs(masses[1] - _daumasses[0]) > 1E-4) or
+      (std::fabs(masses[2] - _daumasses[1]) > 1E-4)) {
+    ERROR("Mass of the mothers do not match!"
+	  " Skipping new decay channel.");
+    return false;
+  }
+
+  if (brfr - 1.0 > 0.0) {
+    ERROR("Branching fraction cannot be > 1.0,"
+	  " skipping new decay channel.");
+    return false;
+  }
+
+  Channel channel;
+  channel.brfr = brfr;
+  _add_vertices(masses, nparts, 0, channel.vertices);
+  _flag_sampled(channel.vertices);
+
+  _channels[0].brfr -= brfr; // Correct primary channel B.F.
+  _channels.push_back(channel);
+  return true;
+}
+
+
+unsigned DecayGenCore::_assign_line_shapes(Vertex &vertex) const
+{
+  unsigned nassigned(0);
+  for (unsigned j = 0; j < NDAUS; ++j) {
+    vertex.shapes[j] = -1;
+    for (unsigned k = 0; k < _shapes.size(); ++k) {
+      if (std::fabs(vertex.daumasses[j] - _shapes[k].get_mass()) < 1E-4) {
+	vertex.shapes[j] = k;
+	nassigned++;
+	break;
+      }
+    }
+  }
+  return nassigned;
+}
+
+
+void DecayGenCore::_flag_sampled(std::vector<Vertex> &vertices)
+{
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    vertices[i].sampled = vertices[i].shapes[0] >= 0 or
+      vertices[i].shapes[1] >= 0;
+  }
+  // the decay vertex of a daughter with a line shape
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    for (unsigned j = 0; j < NDAUS; ++j) {
+      if (vertices[i].shapes[j] < 0 or not vertices[i].decays[j]) continue;
+      for (unsigned k = i + 1; k < vertices.size(); ++k) {
+	if (vertices[k].mother == NDAUS*i + j + 1) vertices[k].sampled = true;
+      }
+    }
+  }
+  return;
+}
+
+
+unsigned DecayGenCore::add_line_shape(const LineShape &shape)
+{
+  // every vertex would be rejected below threshold
+  if (not (shape.get_max() > shape.get_threshold() and
+	   shape.get_mass() > shape.get_threshold())) {
+    ERROR("Line shape of mass " << shape.get_mass() << " has upper cut "
+	  << shape.get_max() << " or nominal mass not above threshold "
+	  << shape.get_threshold() << ", skipping.");
+    return 0;
+  }
+
+  _shapes.push_back(shape);
+  MassBuffer buffer;
+  buffer.next = 0;
+  _massbufs.push_back(buffer);
+
+  unsigned nassigned(0);
+  for (unsigned chid = 0; chid < _channels.size(); ++chid) {
+    std::vector<Vertex> &vertices(_channels[chid].vertices);
+    for (unsigned i = 0; i < vertices.size(); ++i) {
+      nassigned += _assign_line_shapes(vertices[i]);
+    }
+    _flag_sampled(vertices);
+  }
+  if (nassigned == 0) {
+    WARNING("No particle with mass " << shape.get_mass()
+	    << ", line shape unused.");
+  }
+  return nassigned;
+}
+
+
+void DecayGenCore::_fill_masses(unsigned ishape)
+{
+  static const unsigned nbatch(256);
+  MassBuffer &buffer(_massbufs[ishape]);
+  double u[nbatch];
+  for (unsigned i = 0; i < nbatch; ++i) u[i] = rndm();
+  buffer.masses.resize(nbatch);
+  _shapes[ishape].sample(nbatch, u, &buffer.masses[0]);
+  buffer.next = 0;
+  return;
+}
+
+
+bool DecayGenCore::_decay_vertex(const Vertex &vertex, double *particles,
+				 double *dau1, double *dau2)
+{
+  double u1(rndm()), u2(rndm());
+  if (not vertex.sampled) {
+    return DecayKinematics::two_body_decay(particles + 4 * vertex.mother,
+					   vertex.daumasses[0],
+					   vertex.daumasses[1],
+					   u1, u2, dau1, dau2);
+  }
+
+  // with a sampled mother mass the daughters can be above threshold
+  double m1(_daughter_mass(vertex, 0)), m2(_daughter_mass(vertex, 1));
+  _nsampled++;
+  if (not DecayKinematics::two_body_decay(particles + 4 * vertex.mother,
+					  m1, m2, u1, u2, dau1, dau2)) {
+    _nbelow++;
+    return false;
+  }
+  return true;
+}
+
+
+void DecayGenCore::print_line_shape_stats() const
+{
+  std::cout << "Line shapes: " << _shapes.size() << ", vertices with sampled"
+	    << " masses: " << _nsampled << ", rejected below threshold: "
+	    << _nbelow;
+  if (_nsampled) std::cout << " (" << 100.0 * _nbelow / _nsampled << "%)";
+  std::cout << std::endl;
+  return;
+}
+
+
+unsigned DecayGenCore::get_nparticles(unsigned chid) const
+{
+  return 1 + NDAUS * _channels[chid].vertices.size();
+}
+
+
+unsigned DecayGenCore::get_nparticles() const
+{
+  unsigned nparticles(0);
+  for (unsigned chid = 0; chid < _channels.size(); ++chid) {
+    nparticles = std::max(nparticles, get_nparticles(chid));
+  }
+  return nparticles;
+}
+
+
+void DecayGenCore::set_seed(unsigned seed)
+{
+  _rng.seed(seed);
+  // discard masses sampled with the previous seed
+  for (unsigned k = 0; k < _massbufs.size(); ++k) {
+    _massbufs[k].masses.clear();
+    _massbufs[k].next = 0;
+  }
+  return;
+}
+
+
+double DecayGenCore::rndm()
+{
+  return boost::random::uniform_01<double>()(_rng);
+}
+
+
+void DecayGenCore::set_mother_eta_range(double etalo, double etahi)
+{
+  if (etahi < etalo) {
+    ERROR("Invalid η range (" << etalo << ", " << etahi << "), ignoring.");
+    return;
+  }
+  _mother_eta[0] = etalo;
+  _mother_eta[1] = etahi;
+  _cut_mother_eta = true;
+  return;
+}
+
+
+bool DecayGenCore::sample_mother(const TemplateSampler &psampler,
+				 const TemplateSampler *etasampler,
+				 double *mother)
+{
+  // random numbers are drawn in a fixed order (argument evaluation
+  // order is unspecified), so that HypothesisGen can reproduce them
+  double u1(rndm()), u2(rndm());
+  if (etasampler) {
+    double eta(etasampler->sample(u1, u2));
+    // cheap pre-selection, before sampling anything else
+    if (_cut_mother_eta and
+	(eta < _mother_eta[0] or _mother_eta[1] < eta)) {
+      return false;
+    }
+    u1 = rndm();
+    u2 = rndm();
+    double pt(psampler.sample(u1, u2) / std::cosh(eta));
+    double phi(2 * M_PI * rndm());
+    DecayKinematics::set_pt_eta_phi_m(mother, pt, eta, phi, _mommass);
+  } else {
+    if (_cut_mother_eta and not _eta_warned) {
+      WARNING("No mother η template, the mother η range is not applied.");
+      _eta_warned = true;
+    }
+    DecayKinematics::set_xyz_m(mother, 0.0, 0.0,
+			       psampler.sample(u1, u2), _mommass);
+  }
+  return true;
+}
+
+
+unsigned DecayGenCore::choose_channel()
+{
+  double u(rndm());
+  for (unsigned chid = 0; chid + 1 < _channels.size(); ++chid) {
+    if (u < _channels[chid].brfr) return chid;
+    u -= _channels[chid].brfr;
+  }
+  return _channels.size() - 1;
+}
+
+
+double DecayGenCore::generate(unsigned chid, double *particles)
+{
+  const std::vector<Vertex> &vertices(_channels[chid].vertices);
+
+  // without early rejection the whole decay is generated first
+  bool outside(false);
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    const Vertex &vertex(vertices[i]);
+    double *dau1(particles + 4 * (NDAUS*i + 1)), *dau2(dau1 + 4);
+
+    if (not _decay_vertex(vertex, particles, dau1, dau2)) return -1.0;
+
+    if (_full_accept) { // final-state daughters are known now
+      for (unsigned j = 0; j < NDAUS; ++j) {
+	if (not vertex.decays[j] and
+	    not DecayKinematics::in_LHCb(dau1 + 4*j)) {
+	  outside = true;
+	}
+      }
+    } else if (not (vertex.decays[0] or vertex.decays[1])) { // leaf node
+      if (not DecayKinematics::in_LHCb(dau2)) outside = true;
+    }
+    if (outside and _early_reject) return -100;
+  }
+
+  // 2-body phase space weights are always 1
+  return outside ? -100 : 1.0;
+}
+
+
+double DecayGenCore::decay(unsigned chid, double *particles)
+{
+  const std::vector<Vertex> &vertices(_channels[chid].vertices);
+
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    const Vertex &vertex(vertices[i]);
+    double *dau1(particles + 4 * (NDAUS*i + 1)), *dau2(dau1 + 4);
+
+    if (not _decay_vertex(vertex, particles, dau1, dau2)) return -1.0;
+  }
+  return 1.0;
+}
+
+
+bool DecayGenCore::in_acceptance(unsigned chid, const double *particles) const
+{
+  const std::vector<Vertex> &vertices(_channels[chid].vertices);
+
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    const Vertex &vertex(vertices[i]);
+    const double *dau1(particles + 4 * (NDAUS*i + 1)), *dau2(dau1 + 4);
+
+    if (_full_accept) {
+      for (unsigned j = 0; j < NDAUS; ++j) {
+	if (not vertex.decays[j] and
+	    not DecayKinematics::in_LHCb(dau1 + 4*j)) {
+	  return false;
+	}
+      }
+    } else if (not (vertex.decays[0] or vertex.decays[1])) { // leaf node
+      if (not DecayKinematics::in_LHCb(dau2)) return false;
+    }
+  }
+  return true;
+}
+
+
+unsigned DecayGenCore::generate_batch(unsigned nevents, const double *mothers,
+				      double *particles, double *weights,
+				      unsigned *channels)
+{
+  const unsigned nparticles(get_nparticles());
+
+  unsigned naccepted(0);
+  for (unsigned evt = 0; evt < nevents; ++evt) {
+    double *out(particles + 4 * nparticles * evt);
+    std::copy(mothers + 4 * evt, mothers + 4 * (evt + 1), out);
+    std::fill(out + 4, out + 4 * nparticles, 0.0);
+
+    unsigned chid(choose_channel());
+    weights[evt] = generate(chid, out);
+    if (weights[evt] > 0) naccepted++;
+    if (channels) channels[evt] = chid;
+  }
+  return naccepted;
+}
+
+
+void DecayGenCore::print() const
+{
+  std::cout << "mommass: " << _mommass << ", daumass: ("
+	    << _daumasses[0] << "," << _daumasses[1] << ") with "
+	    << _channels.size() << " decay channel(s)." << std::endl;
+
+  for (unsigned chid = 0; chid < _channels.size(); ++chid) {
+    std::cout << "Channel BF: " << _channels[chid].brfr << std::endl;
+    BOOST_FOREACH(Vertex vertex, _channels[chid].vertices) {
+      std::cout << "  particle " << vertex.mother << " -> ("
+		<< vertex.daumasses[0] << (vertex.shapes[0] < 0 ? "" : "*")
+		<< "," << vertex.daumasses[1]
+		<< (vertex.shapes[1] < 0 ? "" : "*") << ")" << std::endl;
+    }
+  }
+  return;
+}
@@ -0,0 +1,439 @@
+/**
+ * @file   DecayGenCore.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 13:14:09 2026
+ *
+ * @brief  ROOT independent core of the 2-body decay generator
+ *
+ *
+ */
+
+#ifndef DECAYGENCORE_HXX
+#define DECAYGENCORE_HXX
+
+// STL headers
+#include <vector>
+
+// Boost headers
+#include <boost/random/mersenne_twister.hpp>
+
+// package headers
+#include "DecayKinematics.hxx"
+#include "TemplateSampler.hxx"
+#include "LineShape.hxx"
+
+
+/**
+ * This class generates sequential 2-body decays without depending on
+ * ROOT.
+ *
+ * It is built from particle mass arrays exactly like TwoBodyDecayGen
+ * (see the TwoBodyDecayGen constructor documentation for the format).
+ * For single-chain trees, where at most one daughter of each vertex
+ * decays further (like Bs → Ds* π, Ds* → Ds γ), it generates the same
+ * decays as a TwoBodyDecayGen tree built that way (the same
+ * distributions, not the same random numbers).  When both daughters
+ * of a vertex decay, TwoBodyDecayGen::find_leaf_nodes returns one
+ * branch per leaf node, e.g. [[(0,1)], []] for
+ * B → (D → K π)(D → K π), and the shorter branches do not decay the
+ * whole tree, while DecayGenCore always generates every vertex of a
+ * channel; the two do not match there.
+ *
+ * Internally each decay channel is stored as a flat list of decay
+ * vertices in generation order, and 4-momenta are written to
+ * plain arrays laid out like the particle_lvs vector of the event
+ * tree: the mother first, followed by the two daughters of each
+ * vertex.  Each 4-momentum is stored as (px, py, pz, E).
+ *
+ * By default all particles have fixed masses.  Resonances can be
+ * given a line shape (see add_line_shape); their masses are then
+ * sampled for each event, and a vertex whose daughters are above the
+ * sampled mother mass is rejected (weight -1).
+ *
+ * The random number generator (Mersenne twister) is owned by the
+ * object, so independent instances can be used in parallel.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-20 Tue
+ *
+ */
+
+class DecayGenCore {
+public:
+
+  /**
+   * Decay vertex in a flattened decay channel
+   */
+  struct Vertex {
+    unsigned mother;		/**< Index of the decaying particle */
+    double daumasses[NDAUS];	/**< Daughter masses */
+    bool decays[NDAUS];		/**< Whether the daughters decay further */
+    int shapes[NDAUS];		/**< Line shape of the daughters (-1: fixed mass) */
+    bool sampled;		/**< Whether any mass at the vertex is sampled */
+  };
+
+  /**
+   * Decay channel: vertices in generation order and B.F.
+   */
+  struct Channel {
+    double brfr;		  /**< Branching fraction */
+    std::vector<Vertex> vertices; /**< Decay vertices */
+  };
+
+  /**
+   * Constructor that takes an array with particle masses for the
+   * entire decay tree.
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   */
+  DecayGenCore(double *masses, unsigned nparts);
+
+  ~DecayGenCore() {}
+
+  /**
+   * Add a new decay channel
+   *
+   * The branching fraction of the first channel is reduced
+   * accordingly.
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   * @param brfr Branching fraction for the channel
+   *
+   * @return Status
+   */
+  bool add_decay_channel(double *masses, unsigned nparts, double brfr);
+
+  /**
+   * Split a particle mass array into the arrays of the daughter trees
+   *
+   * This defines the format of the particle mass arrays, and is also
+   * used by TwoBodyDecayGen.  A daughter array is left empty if the
+   * daughter does not decay.
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   * @param dau1tree Returns particle masses of the first daughter tree
+   * @param dau2tree Returns particle masses of the second daughter tree
+   */
+  static void split_daughter_trees(double *masses, unsigned nparts,
+				   std::vector<double> &dau1tree,
+				   std::vector<double> &dau2tree);
+
+  /**
+   * Sample the mass of a resonance from a line shape
+   *
+   * All daughters (in all decay channels, including channels added
+   * later) with the nominal mass of the line shape use it.  The mass
+   * of the mother particle cannot be changed.  Line shapes whose
+   * nominal mass or upper cut is not above the threshold are
+   * rejected with an error.
+   *
+   * @param shape Line shape (copied)
+   *
+   * @return Number of daughters using the line shape (0 if rejected)
+   */
+  unsigned add_line_shape(const LineShape &shape);
+
+  /**
+   * Return number of line shapes
+   *
+   * @return Number of line shapes
+   */
+  unsigned get_nline_shapes() const { return _shapes.size(); }
+
+  /**
+   * Print number of sampled masses and vertices rejected by threshold
+   */
+  void print_line_shape_stats() const;
+
+  /**
+   * Return number of decay channels
+   *
+   * @return Number of channels
+   */
+  unsigned get_nchannels() const { return _channels.size(); }
+
+  /**
+   * Return decay channel
+   *
+   * @param chid Decay channel id
+   *
+   * @return Decay channel
+   */
+  const Channel& get_channel(unsigned chid) const { return _channels[chid]; }
+
+  /**
+   * Return BF for decay channel
+   *
+   * @param chid Decay channel id
+   *
+   * @return Branching fraction for decay channel
+   */
+  double get_brfr(unsigned chid) const { return _channels[chid].brfr; }
+
+  /**
+   * Return number of particles (including the mother) in a channel
+   *
+   * @param chid Decay channel id
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles(unsigned chid) const;
+
+  /**
+   * Return number of particles in the largest decay channel
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles() const;
+
+  /**
+   * Return mass of the mother particle
+   *
+   * @return Mass in GeV/c²
+   */
+  double get_mass() const { return _mommass; }
+
+  /**
+   * Seed the random number generator
+   *
+   * @param seed Seed
+   */
+  void set_seed(unsigned seed);
+
+  /**
+   * Return a uniform random number in [0, 1)
+   *
+   * @return Random number
+   */
+  double rndm();
+
+  /**
+   * Choose the acceptance definition
+   *
+   * Same as TwoBodyDecayGen::set_full_acceptance: all final-state
+   * particles, or (default) the second daughter of each leaf vertex
+   * have to be inside the LHCb acceptance.
+   *
+   * @param full Require all final-state particles in acceptance
+   */
+  void set_full_acceptance(bool full=true) { _full_accept = full; }
+
+  /**
+   * Return if all final-state particles have to be in acceptance
+   *
+   * @return Full acceptance definition
+   */
+  bool get_full_acceptance() const { return _full_accept; }
+
+  /**
+   * Enable or disable early rejection
+   *
+   * Same as TwoBodyDecayGen::set_early_rejection: events are
+   * rejected at the first particle outside the acceptance, instead of
+   * after the whole decay.  Only the number of random numbers drawn
+   * for rejected events changes, not which events are accepted.
+   *
+   * @param early Use early rejection
+   */
+  void set_early_rejection(bool early=true) { _early_reject = early; }
+
+  /**
+   * Return if early rejection is enabled
+   *
+   * @return Early rejection
+   */
+  bool get_early_rejection() const { return _early_reject; }
+
+  /**
+   * Reject mothers outside a pseudorapidity range before decaying
+   *
+   * Same as TwoBodyDecayGen::set_mother_eta_range.
+   *
+   * @param etalo Lower bound on mother η
+   * @param etahi Upper bound on mother η
+   */
+  void set_mother_eta_range(double etalo, double etahi);
+
+  /**
+   * Sample mother 4-momentum from templates
+   *
+   * Same as get_event_tree in TwoBodyDecayGen: the momentum is along
+   * the z-axis if no η template is given.  The mother η range is then
+   * not applied, which is reported by a warning (once).
+   *
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   * @param mother Returns mother 4-momentum
+   *
+   * @return False if rejected by the mother η range
+   */
+  bool sample_mother(const TemplateSampler &psampler,
+		     const TemplateSampler *etasampler, double *mother);
+
+  /**
+   * Choose a decay channel randomly according to the B.F.
+   *
+   * @return Decay channel id
+   */
+  unsigned choose_channel();
+
+  /**
+   * Generate one event
+   *
+   * @param chid Decay channel id
+   * @param particles 4-momenta of all particles, the mother has to be set
+   *
+   * @return Event weight (≤ 0 if rejected, like TwoBodyDecayGen::generate)
+   */
+  double generate(unsigned chid, double *particles);
+
+  /**
+   * Generate the decay kinematics of one event without acceptance
+   *
+   * Together with in_acceptance this is the same as generate, but
+   * the two steps can be run separately (e.g. by PipelineGen).
+   *
+   * @param chid Decay channel id
+   * @param particles 4-momenta of all particles, the mother has to be set
+   *
+   * @return Event weight (-1 if not permitted by kinematics)
+   */
+  double decay(unsigned chid, double *particles);
+
+  /**
+   * Return if a decayed event is inside the acceptance
+   *
+   * With the full acceptance definition all final-state particles
+   * are checked, otherwise the second daughter of each leaf vertex,
+   * like generate.
+   *
+   * @param chid Decay channel id
+   * @param particles 4-momenta of all particles
+   *
+   * @return Inside acceptance or not
+   */
+  bool in_acceptance(unsigned chid, const double *particles) const;
+
+  /**
+   * Generate a batch of events into flat, caller owned buffers
+   *
+   * For each mother 4-momentum a decay channel is chosen randomly
+   * according to the branching fractions.  Buffers are laid out as C
+   * arrays: mothers[nevents][4], particles[nevents][nparticles][4]
+   * with nparticles from get_nparticles().  4-momenta are stored as
+   * (px, py, pz, E); the mother is copied to the first particle, and
+   * unused particles of smaller channels are set to 0.  Events that
+   * fail the kinematics or the acceptance have weight ≤ 0.
+   *
+   * @param nevents Number of events
+   * @param mothers Mother 4-momenta
+   * @param particles Returns 4-momenta of all particles
+   * @param weights Returns event weights
+   * @param channels Returns decay channel id, optional
+   *
+   * @return Number of events with positive weight
+   */
+  unsigned generate_batch(unsigned nevents, const double *mothers,
+			  double *particles, double *weights,
+			  unsigned *channels=NULL);
+
+  /**
+   * Print decay channels
+   */
+  void print() const;
+
+private:
+
+  /**
+   * Append the vertices of a decay tree to a channel
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   * @param mother Index of the decaying particle
+   * @param vertices Vertices of the channel
+   */
+  void _add_vertices(double *masses, unsigned nparts, unsigned mother,
+		     std::vector<Vertex> &vertices);
+
+  /**
+   * Assign line shapes to the daughters of a vertex
+   *
+   * @param vertex Decay vertex
+   *
+   * @return Number of daughters with a line shape
+   */
+  unsigned _assign_line_shapes(Vertex &vertex) const;
+
+  /**
+   * Flag vertices where the mother or a daughter mass is sampled
+   *
+   * @param vertices Vertices of a channel
+   */
+  static void _flag_sampled(std::vector<Vertex> &vertices);
+
+  /**
+   * Return daughter mass, sampled if it has a line shape
+   *
+   * Masses are sampled in batches, which are refilled when empty.
+   *
+   * @param vertex Decay vertex
+   * @param j Daughter
+   *
+   * @return Mass in GeV/c²
+   */
+  double _daughter_mass(const Vertex &vertex, unsigned j)
+  {
+    if (vertex.shapes[j] < 0) return vertex.daumasses[j];
+    MassBuffer &buffer(_massbufs[vertex.shapes[j]]);
+    if (buffer.next == buffer.masses.size()) _fill_masses(vertex.shapes[j]);
+    return buffer.masses[buffer.next++];
+  }
+
+  /**
+   * Refill the sampled masses of a line shape
+   *
+   * @param ishape Line shape index
+   */
+  void _fill_masses(unsigned ishape);
+
+  /**
+   * Generate the kinematics of one vertex
+   *
+   * @param vertex Decay vertex
+   * @param particles 4-momenta of all particles
+   * @param dau1 Returns first daughter 4-momentum
+   * @param dau2 Returns second daughter 4-momentum
+   *
+   * @return False if not permitted by kinematics
+   */
+  bool _decay_vertex(const Vertex &vertex, double *particles,
+		     double *dau1, double *dau2);
+
+  /**
+   * Masses sampled from a line shape, used in order
+   */
+  struct MassBuffer {
+    std::vector<double> masses;	/**< Sampled masses */
+    unsigned next;		/**< Next unused mass */
+  };
+
+  static unsigned long long _count; /**< Debug message counter */
+  double _mommass;		/**< Mother particle mass */
+  double _daumasses[NDAUS];	/**< Array of the two daughter masses */
+  bool _full_accept;		/**< All final-state particles in acceptance */
+  bool _early_reject;		/**< Reject events as early as possible */
+  bool _cut_mother_eta;		/**< Apply mother η range before decaying */
+  bool _eta_warned;		/**< Warned that the η range is not applied */
+  double _mother_eta[2];	/**< Allowed mother η range */
+  std::vector<Channel> _channels; /**< Decay channels */
+  boost::random::mt19937 _rng;	/**< Random number generator */
+  std::vector<LineShape> _shapes; /**< Resonance line shapes */
+  std::vector<MassBuffer> _massbufs; /**< Sampled masses per line shape */
+  unsigned long _nsampled;	/**< Vertices with sampled masses */
+  unsigned long _nbelow;	/**< Of those, rejected below threshold */
+};
+
+#endif	// DECAYGENCORE_HXX
@@ -0,0 +1,53 @@
+/**
+ * @file   DecayGenMessages.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 19 10:12:40 2026
+ *
+ * @brief  Message macros shared by the generator classes
+ *
+ * Each class using these macros must provide a (static) counter
+ * named _count.
+ *
+ */
+
+#ifndef DECAYGENMESSAGES_HXX
+#define DECAYGENMESSAGES_HXX
+
+// STL headers
+#include <iostream>
+#include <iomanip>
+
+
+/**
+ * \def DEBUG(MSG)
+ * Debug statement with a counter
+ */
+
+#define DEBUG(MSG)  \
+  std::cout << "DEBUG: [" << std::setw(4) << std::setfill('0') << _count \
+  << "] (" << __func__ << ") " << MSG << std::endl; \
+  _count++;
+
+
+/**
+ * \def WARNING(MSG)
+ * Warning with a counter
+ */
+
+#define WARNING(MSG)  \
+  std::cout << "WARNING: [" << std::setw(4) << std::setfill('0') << _count \
+  << "] (" << __func__ << ") " << MSG << std::endl; \
+  _count++;
+
+
+/**
+ * \def ERROR(MSG)
+ * Error message with a counter
+ */
+
+#define ERROR(MSG)  \
+  std::cout << "ERROR: [" << std::setw(4) << std::setfill('0') << _count \
+  << "] (" << __func__ << ") "	<< MSG << std::endl; \
+  _count++;
+
+#endif	// DECAYGENMESSAGES_HXX
@@ -0,0 +1,155 @@
+/**
+ * @file   DecayKinematics.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 10:20:35 2026
+ *
+ * @brief  Implementation of DecayKinematics
+ *
+ *
+ */
+
+/**
+ * \def _USE_MATH_DEFINES
+ * Enable definitions from cmath (e.g. mathematical constants)
+ */
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+// package headers
+#include "DecayKinematics.hxx"
+
+
+// slopes corresponding to the acceptance, computed once
+static const double XZ_SLOPE_LO(std::tan(DecayKinematics::XZ_ANGLE_LO)),
+  XZ_SLOPE_HI(std::tan(DecayKinematics::XZ_ANGLE_HI)),
+  YZ_SLOPE_LO(std::tan(DecayKinematics::YZ_ANGLE_LO)),
+  YZ_SLOPE_HI(std::tan(DecayKinematics::YZ_ANGLE_HI));
+
+
+bool DecayKinematics::in_LHCb(const double *lv)
+{
+  double xz_slope(std::fabs(lv[0]/lv[2])), yz_slope(std::fabs(lv[1]/lv[2]));
+
+  if (XZ_SLOPE_LO < xz_slope and xz_slope < XZ_SLOPE_HI and
+      YZ_SLOPE_LO < yz_slope and yz_slope < YZ_SLOPE_HI) {
+    return true;
+  }
+
+  return false;
+}
+
+
+void DecayKinematics::set_pt_eta_phi_m(double *lv, double pt, double eta,
+				       double phi, double mass)
+{
+  set_xyz_m(lv, pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta),
+	    mass);
+  return;
+}
+
+
+void DecayKinematics::set_xyz_m(double *lv, double px, double py, double pz,
+				double mass)
+{
+  lv[0] = px;
+  lv[1] = py;
+  lv[2] = pz;
+  lv[3] = std::sqrt(px*px + py*py + pz*pz + mass*mass);
+  return;
+}
+
+
+double DecayKinematics::two_body_momentum(double mass, double m1, double m2)
+{
+  double sum(m1 + m2), diff(m1 - m2);
+  double arg((mass*mass - sum*sum) * (mass*mass - diff*diff));
+  if (mass < sum or arg < 0.0) return -1.0;
+  return std::sqrt(arg) / (2.0 * mass);
+}
+
+
+bool DecayKinematics::two_body_decay(const double *mom, double m1, double m2,
+				     double u1, double u2,
+				     double *dau1, double *dau2)
+{
+  double mass2(mom[3]*mom[3] - mom[0]*mom[0] - mom[1]*mom[1] - mom[2]*mom[2]);
+  if (mass2 <= 0.0) return false;
+  double mass(std::sqrt(mass2));
+
+  double pstar(two_body_momentum(mass, m1, m2));
+  if (pstar < 0.0) return false;
+
+  // daughters in the mother rest frame
+  double costh(2.0 * u1 - 1.0), sinth(std::sqrt(1.0 - costh*costh));
+  double phi(2.0 * M_PI * u2);
+  double p[3] = {pstar * sinth * std::cos(phi), pstar * sinth * std::sin(phi),
+		 pstar * costh};
+  double e1(std::sqrt(pstar*pstar + m1*m1)), e2(std::sqrt(pstar*pstar + m2*m2));
+
+  // boost to the lab frame
+  double b[3] = {mom[0]/mom[3], mom[1]/mom[3], mom[2]/mom[3]};
+  double b2(b[0]*b[0] + b[1]*b[1] + b[2]*b[2]);
+  double gamma(1.0 / std::sqrt(1.0 - b2));
+  double gamma2(b2 > 0.0 ? (gamma - 1.0) / b2 : 0.0);
+  double bp(b[0]*p[0] + b[1]*p[1] + b[2]*p[2]);
+
+  for (unsigned i = 0; i < 3; ++i) {
+    dau1[i] = p[i] + gamma2 * bp * b[i] + gamma * b[i] * e1;
+    dau2[i] = -p[i] - gamma2 * bp * b[i] + gamma * b[i] * e2;
+  }
+  dau1[3] = gamma * (e1 + bp);
+  dau2[3] = gamma * (e2 - bp);
+  return true;
+}
+
+
+void DecayKinematics::two_body_decay_n(unsigned n, const double *mom,
+				       const double *m1, const double *m2,
+				       double u1, double u2,
+				       double *dau1, double *dau2,
+				       double *weights)
+{
+  // direction in the mother rest frame is the same for all hypotheses
+  double costh(2.0 * u1 - 1.0), sinth(std::sqrt(1.0 - costh*costh));
+  double phi(2.0 * M_PI * u2);
+  double dir[3] = {sinth * std::cos(phi), sinth * std::sin(phi), costh};
+
+  const double *px(mom), *py(mom + n), *pz(mom + 2*n), *e(mom + 3*n);
+  double *d1px(dau1), *d1py(dau1 + n), *d1pz(dau1 + 2*n), *d1e(dau1 + 3*n);
+  double *d2px(dau2), *d2py(dau2 + n), *d2pz(dau2 + 2*n), *d2e(dau2 + 3*n);
+
+  // branch free, forbidden decays are masked with the weight; the
+  // arrays do not overlap, so the loop can be vectorised
+#pragma GCC ivdep
+  for (unsigned i = 0; i < n; ++i) {
+    double mass2(e[i]*e[i] - px[i]*px[i] - py[i]*py[i] - pz[i]*pz[i]);
+    double mass(std::sqrt(mass2 > 0.0 ? mass2 : 0.0));
+    double sum(m1[i] + m2[i]), diff(m1[i] - m2[i]);
+    double arg((mass2 - sum*sum) * (mass2 - diff*diff));
+    bool ok((mass2 > 0.0) & (mass >= sum) & (arg >= 0.0));
+    weights[i] = ok ? weights[i] : -1.0;
+
+    double pstar(ok ? std::sqrt(arg) / (2.0 * mass) : 0.0);
+    double e1(std::sqrt(pstar*pstar + m1[i]*m1[i]));
+    double e2(std::sqrt(pstar*pstar + m2[i]*m2[i]));
+
+    // boost to the lab frame
+    double inve(ok ? 1.0 / e[i] : 0.0);
+    double bx(px[i] * inve), by(py[i] * inve), bz(pz[i] * inve);
+    double b2(bx*bx + by*by + bz*bz);
+    double gamma(1.0 / std::sqrt(ok ? 1.0 - b2 : 1.0));
+    double gamma2(b2 > 0.0 ? (gamma - 1.0) / b2 : 0.0);
+    double p1x(pstar * dir[0]), p1y(pstar * dir[1]), p1z(pstar * dir[2]);
+    double bp(bx*p1x + by*p1y + bz*p1z);
+
+    d1px[i] = p1x + gamma2 * bp * bx + gamma * bx * e1;
+    d1py[i] = p1y + gamma2 * bp * by + gamma * by * e1;
+    d1pz[i] = p1z + gamma2 * bp * bz + gamma * bz * e1;
+    d1e[i] = gamma * (e1 + bp);
+    d2px[i] = -p1x - gamma2 * bp * bx + gamma * bx * e2;
+    d2py[i] = -p1y - gamma2 * bp * by + gamma * by * e2;
+    d2pz[i] = -p1z - gamma2 * bp * bz + gamma * bz * e2;
+    d2e[i] = gamma * (e2 - bp);
+  }
+  return;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file   DecayKinematics.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 09:47:12 2026
+ *
+ * @brief  ROOT independent 2-body decay kinematics and acceptance
+ *
+ * 4-momenta are stored as plain arrays of 4 doubles: (px, py, pz, E).
+ *
+ */
+
+#ifndef DECAYKINEMATICS_HXX
+#define DECAYKINEMATICS_HXX
+
+#define NDAUS 2			/**< Number of daughters, fixed to 2 */
+
+
+/**
+ * Kinematics routines shared by the generator classes.
+ *
+ * These do not depend on ROOT, so that they can be used by the core
+ * library (see DecayGenCore).
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-20 Tue
+ *
+ */
+
+namespace DecayKinematics {
+
+  // LHCb acceptance (in radians)
+  // - x-z plane: 10 - 300 mrad
+  // - y-z plane: 10 - 250 mrad
+  const double XZ_ANGLE_LO(1E-2); /**< Lower edge of acceptance in x-z plane */
+  const double XZ_ANGLE_HI(3E-1); /**< Upper edge of acceptance in x-z plane */
+  const double YZ_ANGLE_LO(1E-2); /**< Lower edge of acceptance in y-z plane */
+  const double YZ_ANGLE_HI(2.5E-1); /**< Upper edge of acceptance in y-z plane */
+
+  /**
+   * Return if the particle is in LHCb detector acceptance
+   *
+   * @param lv Particle 4-momentum
+   *
+   * @return Inside LHCb acceptance or not
+   */
+  bool in_LHCb(const double *lv);
+
+  /**
+   * Set 4-momentum from transverse momentum, η, φ and mass
+   *
+   * @param lv Returns 4-momentum
+   * @param pt Transverse momentum
+   * @param eta Pseudorapidity
+   * @param phi Azimuthal angle
+   * @param mass Mass
+   */
+  void set_pt_eta_phi_m(double *lv, double pt, double eta, double phi,
+			double mass);
+
+  /**
+   * Set 4-momentum from 3-momentum and mass
+   *
+   * @param lv Returns 4-momentum
+   * @param px x-component of the momentum
+   * @param py y-component of the momentum
+   * @param pz z-component of the momentum
+   * @param mass Mass
+   */
+  void set_xyz_m(double *lv, double px, double py, double pz, double mass);
+
+  /**
+   * Return magnitude of the daughter momenta in the mother rest frame
+   *
+   * @param mass Mother mass
+   * @param m1 Mass of the first daughter
+   * @param m2 Mass of the second daughter
+   *
+   * @return Momentum (-ve if the decay is kinematically forbidden)
+   */
+  double two_body_momentum(double mass, double m1, double m2);
+
+  /**
+   * Generate an isotropic 2-body decay
+   *
+   * The decay angles are given by two uniform random numbers in
+   * [0, 1): cos θ = 2 u1 - 1 and φ = 2π u2 in the mother rest frame.
+   *
+   * @param mom Mother 4-momentum
+   * @param m1 Mass of the first daughter
+   * @param m2 Mass of the second daughter
+   * @param u1 Random number for the polar angle
+   * @param u2 Random number for the azimuthal angle
+   * @param dau1 Returns 4-momentum of the first daughter
+   * @param dau2 Returns 4-momentum of the second daughter
+   *
+   * @return False if the decay is kinematically forbidden
+   */
+  bool two_body_decay(const double *mom, double m1, double m2,
+		      double u1, double u2, double *dau1, double *dau2);
+
+  /**
+   * Generate the same 2-body decay for several mass hypotheses
+   *
+   * The decay angles (u1, u2) are shared by all hypotheses, as in
+   * two_body_decay.  4-momenta are stored component-wise (structure
+   * of arrays): mom[c*n + i] is component c of hypothesis i, so the
+   * loop over hypotheses can be vectorised.  The weight of a
+   * hypothesis is set to -1 if its decay is kinematically forbidden
+   * (its daughters are then finite, but meaningless).
+   *
+   * @param n Number of hypotheses
+   * @param mom Mother 4-momenta (4 × n)
+   * @param m1 Masses of the first daughter (n)
+   * @param m2 Masses of the second daughter (n)
+   * @param u1 Random number for the polar angle
+   * @param u2 Random number for the azimuthal angle
+   * @param dau1 Returns 4-momenta of the first daughter (4 × n)
+   * @param dau2 Returns 4-momenta of the second daughter (4 × n)
+   * @param weights Event weights of the hypotheses (n)
+   */
+  void two_body_decay_n(unsigned n, const double *mom, const double *m1,
+			const double *m2, double u1, double u2,
+			double *dau1, double *dau2, double *weights);
+
+}
+
+#endif	// DECAYKINEMATICS_HXX
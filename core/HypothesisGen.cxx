@@ -0,0 +1,147 @@
+/**
+ * @file   HypothesisGen.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Sat Oct 24 11:02:27 2026
+ *
+ * @brief  Implementation of HypothesisGen
+ *
+ *
+ */
+
+/**
+ * \def _USE_MATH_DEFINES
+ * Enable definitions from cmath (e.g. mathematical constants)
+ */
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+// package headers
+#include "HypothesisGen.hxx"
+#include "DecayGenMessages.hxx"
+
+
+unsigned long long HypothesisGen::_count(0);
+
+
+HypothesisGen::HypothesisGen(double *masses, unsigned nparts)
+{
+  _hypotheses.push_back(DecayGenCore(masses, nparts));
+  _mommasses.push_back(masses[0]);
+  _daumasses.resize(NDAUS * _hypotheses[0].get_channel(0).vertices.size());
+  _soa.resize(4 * get_nparticles());
+
+  const std::vector<DecayGenCore::Vertex>
+    &vertices(_hypotheses[0].get_channel(0).vertices);
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    for (unsigned j = 0; j < NDAUS; ++j) {
+      _daumasses[NDAUS*i + j] = vertices[i].daumasses[j];
+    }
+  }
+}
+
+
+bool HypothesisGen::add_hypothesis(double *masses, unsigned nparts)
+{
+  DecayGenCore hypothesis(masses, nparts);
+  const std::vector<DecayGenCore::Vertex>
+    &nominal(_hypotheses[0].get_channel(0).vertices),
+    &vertices(hypothesis.get_channel(0).vertices);
+
+  bool same(nominal.size() == vertices.size());
+  for (unsigned i = 0; same and i < vertices.size(); ++i) {
+    same = nominal[i].mother == vertices[i].mother;
+    for (unsigned j = 0; j < NDAUS; ++j) {
+      same = same and nominal[i].decays[j] == vertices[i].decays[j];
+    }
+  }
+  if (not same) {
+    ERROR("Decay tree differs from the first hypothesis, skipping.");
+    return false;
+  }
+
+  hypothesis.set_full_acceptance(_hypotheses[0].get_full_acceptance());
+  _hypotheses.push_back(hypothesis);
+  _mommasses.push_back(masses[0]);
+
+  // rebuild the hypothesis-major mass table
+  const unsigned nhypo(_hypotheses.size());
+  std::vector<double> daumasses(NDAUS * vertices.size() * nhypo);
+  for (unsigned k = 0; k < daumasses.size() / nhypo; ++k) {
+    for (unsigned h = 0; h + 1 < nhypo; ++h) {
+      daumasses[k*nhypo + h] = _daumasses[k*(nhypo - 1) + h];
+    }
+    daumasses[k*nhypo + nhypo - 1] = vertices[k / NDAUS].daumasses[k % NDAUS];
+  }
+  _daumasses.swap(daumasses);
+  _soa.resize(4 * get_nparticles() * nhypo);
+  return true;
+}
+
+
+void HypothesisGen::set_full_acceptance(bool full)
+{
+  for (unsigned h = 0; h < _hypotheses.size(); ++h) {
+    _hypotheses[h].set_full_acceptance(full);
+  }
+  return;
+}
+
+
+unsigned HypothesisGen::generate(const TemplateSampler &psampler,
+				 const TemplateSampler *etasampler,
+				 double *particles, double *weights)
+{
+  DecayGenCore &rng(_hypotheses[0]);
+  const unsigned nhypo(_hypotheses.size()), nparticles(get_nparticles());
+  const std::vector<DecayGenCore::Vertex> &vertices(rng.get_channel(0).vertices);
+
+  // shared mother kinematics, same order of random numbers as
+  // DecayGenCore::sample_mother
+  double lv[4];
+  double u1(rng.rndm()), u2(rng.rndm());
+  if (etasampler) {
+    double eta(etasampler->sample(u1, u2));
+    u1 = rng.rndm();
+    u2 = rng.rndm();
+    double pt(psampler.sample(u1, u2) / std::cosh(eta));
+    double phi(2 * M_PI * rng.rndm());
+    DecayKinematics::set_pt_eta_phi_m(lv, pt, eta, phi, 0.0);
+  } else {
+    DecayKinematics::set_xyz_m(lv, 0.0, 0.0, psampler.sample(u1, u2), 0.0);
+  }
+  double p2(lv[0]*lv[0] + lv[1]*lv[1] + lv[2]*lv[2]);
+  for (unsigned h = 0; h < nhypo; ++h) {
+    for (unsigned c = 0; c < 3; ++c) _soa[c*nhypo + h] = lv[c];
+    _soa[3*nhypo + h] = std::sqrt(p2 + _mommasses[h]*_mommasses[h]);
+    weights[h] = 1.0;
+  }
+
+  // shared decay angles, all hypotheses at once
+  for (unsigned i = 0; i < vertices.size(); ++i) {
+    double u1(rng.rndm()), u2(rng.rndm());
+    DecayKinematics::two_body_decay_n(nhypo,
+				      &_soa[4*nhypo * vertices[i].mother],
+				      &_daumasses[NDAUS*i * nhypo],
+				      &_daumasses[(NDAUS*i + 1) * nhypo],
+				      u1, u2,
+				      &_soa[4*nhypo * (NDAUS*i + 1)],
+				      &_soa[4*nhypo * (NDAUS*i + 2)],
+				      weights);
+  }
+
+  // back to one 4-momentum per particle, and acceptance
+  unsigned naccepted(0);
+  for (unsigned h = 0; h < nhypo; ++h) {
+    double *out(particles + 4 * nparticles * h);
+    for (unsigned k = 0; k < nparticles; ++k) {
+      for (unsigned c = 0; c < 4; ++c) {
+	out[4*k + c] = _soa[(4*k + c) * nhypo + h];
+      }
+    }
+    if (weights[h] > 0 and not _hypotheses[h].in_acceptance(0, out)) {
+      weights[h] = -100;
+    }
+    if (weights[h] > 0) naccepted++;
+  }
+  return naccepted;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file   HypothesisGen.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Sat Oct 24 10:15:52 2026
+ *
+ * @brief  Correlated generation of a decay for several mass hypotheses
+ *
+ *
+ */
+
+#ifndef HYPOTHESISGEN_HXX
+#define HYPOTHESISGEN_HXX
+
+// STL headers
+#include <vector>
+
+// package headers
+#include "DecayGenCore.hxx"
+#include "TemplateSampler.hxx"
+
+
+/**
+ * This class generates one decay topology for several sets of
+ * particle masses (hypotheses) at once.
+ *
+ * All hypotheses share the same random numbers: the mother momentum,
+ * η and φ, and the decay angles of every vertex.  The samples are
+ * therefore strongly correlated, and differences between hypotheses
+ * (e.g. daughter mass systematics) have much smaller statistical
+ * fluctuations than with independently generated samples.  The decay
+ * kinematics is computed for all hypotheses in one vectorised loop
+ * (DecayKinematics::two_body_decay_n), so N hypotheses cost little
+ * more than one.
+ *
+ * Hypotheses are given as particle mass arrays in the same format as
+ * for DecayGenCore, and must have the same decay tree.  Only the
+ * primary decay channel is used.  The first hypothesis is generated
+ * like DecayGenCore::sample_mother followed by DecayGenCore::generate
+ * of channel 0 with the same seed and without early rejection
+ * (checked by core/testhypothesis).  There is no early rejection
+ * here: all random numbers are always drawn, as other hypotheses may
+ * still be accepted.
+ *
+ * <b>Warning:</b> line shapes (DecayGenCore::add_line_shape) and the
+ * mother η range (DecayGenCore::set_mother_eta_range) are ignored.
+ * All particles have the fixed masses of their hypothesis, and every
+ * sampled mother is used, so results differ from a DecayGenCore
+ * configured with either.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-24 Sat
+ *
+ */
+
+class HypothesisGen {
+public:
+
+  /**
+   * Constructor with the first (nominal) hypothesis
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   */
+  HypothesisGen(double *masses, unsigned nparts);
+
+  ~HypothesisGen() {}
+
+  /**
+   * Add a mass hypothesis
+   *
+   * @param masses Array of doubles with mass of all the particles in GeV/c²
+   * @param nparts Number of particles in the decay tree (length of the array)
+   *
+   * @return False if the decay tree differs from the first hypothesis
+   */
+  bool add_hypothesis(double *masses, unsigned nparts);
+
+  /**
+   * Return number of hypotheses
+   *
+   * @return Number of hypotheses
+   */
+  unsigned get_nhypotheses() const { return _hypotheses.size(); }
+
+  /**
+   * Return number of particles (including the mother)
+   *
+   * @return Number of particles
+   */
+  unsigned get_nparticles() const { return _hypotheses[0].get_nparticles(0); }
+
+  /**
+   * Seed the random number generator
+   *
+   * @param seed Seed
+   */
+  void set_seed(unsigned seed) { _hypotheses[0].set_seed(seed); }
+
+  /**
+   * Choose the acceptance definition
+   *
+   * See DecayGenCore::set_full_acceptance.
+   *
+   * @param full Require all final-state particles in acceptance
+   */
+  void set_full_acceptance(bool full=true);
+
+  /**
+   * Generate one event for all hypotheses
+   *
+   * Particles are laid out as a C array particles[nhypotheses][nparticles][4],
+   * each hypothesis like DecayGenCore::generate.
+   *
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   * @param particles Returns 4-momenta of all particles
+   * @param weights Returns event weight of each hypothesis (≤ 0 if rejected)
+   *
+   * @return Number of hypotheses with positive weight
+   */
+  unsigned generate(const TemplateSampler &psampler,
+		    const TemplateSampler *etasampler,
+		    double *particles, double *weights);
+
+private:
+
+  static unsigned long long _count; /**< Debug message counter */
+  std::vector<DecayGenCore> _hypotheses; /**< Generator per hypothesis */
+  std::vector<double> _mommasses; /**< Mother masses, [hypothesis] */
+  std::vector<double> _daumasses; /**< Daughter masses, [vertex][daughter][hypothesis] */
+  std::vector<double> _soa;	  /**< 4-momenta, [particle][component][hypothesis] */
+};
+
+#endif	// HYPOTHESISGEN_HXX
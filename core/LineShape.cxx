@@ -0,0 +1,91 @@
+/**
+ * @file   LineShape.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 26 11:12:56 2026
+ *
+ * @brief  Implementation of LineShape
+ *
+ *
+ */
+
+// STL headers
+#include <cmath>
+#include <algorithm>
+
+// package headers
+#include "LineShape.hxx"
+#include "DecayKinematics.hxx"
+
+
+LineShape::LineShape(double m0, double width, double ma, double mb,
+		     unsigned L, double mmax, double radius,
+		     unsigned ntable) :
+  _m0(m0), _width(width), _ma(ma), _mb(mb), _L(std::min(L, 2u)),
+  _mmax(mmax < 0.0 ? m0 + 20 * width : mmax), _radius(radius),
+  _q0(DecayKinematics::two_body_momentum(m0, ma, mb)),
+  _table(std::max(ntable, 2u), m0)
+{
+  if (not (_width > 0.0) or _q0 < 0.0) return; // fixed mass
+
+  // cumulative distribution on a fine grid (trapezoidal rule)
+  const double mmin(ma + mb);
+  const unsigned ngrid(8 * _table.size());
+  const double step((_mmax - mmin) / ngrid);
+  std::vector<double> cdf(ngrid + 1, 0.0);
+  double prev(get_density(mmin));
+  for (unsigned i = 1; i <= ngrid; ++i) {
+    double cur(get_density(mmin + i * step));
+    cdf[i] = cdf[i - 1] + 0.5 * (prev + cur) * step;
+    prev = cur;
+  }
+  if (not (cdf.back() > 0.0)) return;
+
+  // invert at equidistant quantiles
+  unsigned j(0);
+  for (unsigned i = 0; i < _table.size(); ++i) {
+    double target(cdf.back() * i / (_table.size() - 1));
+    while (j + 1 < ngrid and cdf[j + 1] < target) ++j;
+    double frac(cdf[j + 1] > cdf[j] ?
+		(target - cdf[j]) / (cdf[j + 1] - cdf[j]) : 0.0);
+    _table[i] = mmin + (j + std::min(frac, 1.0)) * step;
+  }
+}
+
+
+double LineShape::_barrier2(double q) const
+{
+  double z(q * q * _radius * _radius);
+  switch (_L) {
+  case 0:
+    return 1.0;
+  case 1:
+    return 1.0 / (1.0 + z);
+  default:
+    return 1.0 / (z*z + 3*z + 9);
+  }
+}
+
+
+double LineShape::get_width(double m) const
+{
+  double q(DecayKinematics::two_body_momentum(m, _ma, _mb));
+  if (q < 0.0 or _q0 <= 0.0) return 0.0;
+  return _width * std::pow(q / _q0, 2.0 * _L + 1) * (_m0 / m) *
+    _barrier2(q) / _barrier2(_q0);
+}
+
+
+double LineShape::get_density(double m) const
+{
+  double width(get_width(m));
+  double diff(_m0*_m0 - m*m);
+  double denom(diff*diff + _m0*_m0 * width*width);
+  return denom > 0.0 ? m * _m0 * width / denom : 0.0;
+}
+
+
+void LineShape::sample(unsigned n, const double *u, double *masses) const
+{
+  for (unsigned i = 0; i < n; ++i) masses[i] = sample(u[i]);
+  return;
+}
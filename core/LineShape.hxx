@@ -0,0 +1,146 @@
+/**
+ * @file   LineShape.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 26 10:08:31 2026
+ *
+ * @brief  Table driven resonance line shapes
+ *
+ *
+ */
+
+#ifndef LINESHAPE_HXX
+#define LINESHAPE_HXX
+
+// STL headers
+#include <vector>
+
+
+/**
+ * Relativistic Breit–Wigner line shape with mass-dependent width.
+ *
+ * The resonance of nominal mass m0 and width Γ0 decays to two
+ * particles of masses ma and mb with orbital angular momentum L.  The
+ * width depends on the break-up momentum q(m):
+ *
+ *   Γ(m) = Γ0 (q/q0)^(2L+1) (m0/m) B_L(q)² / B_L(q0)²
+ *
+ * with Blatt–Weisskopf barrier factors B_L (L ≤ 2) and the density is
+ *
+ *   f(m) ∝ m m0 Γ(m) / ((m0² - m²)² + m0² Γ(m)²)
+ *
+ * between the threshold ma + mb and an upper cut.  An inverse
+ * cumulative distribution table is built by the constructor, so that
+ * sampling a mass is a table lookup with linear interpolation.  A
+ * zero width gives a fixed mass.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-26 Mon
+ *
+ */
+
+class LineShape {
+public:
+
+  /**
+   * Constructor, builds the sampling table
+   *
+   * @param m0 Nominal mass in GeV/c²
+   * @param width Nominal width in GeV/c²
+   * @param ma Mass of the first decay product in GeV/c²
+   * @param mb Mass of the second decay product in GeV/c²
+   * @param L Orbital angular momentum of the decay (0, 1 or 2)
+   * @param mmax Upper mass cut, above ma + mb (-ve for m0 + 20 Γ0)
+   * @param radius Blatt–Weisskopf radius in (GeV/c)⁻¹
+   * @param ntable Number of table entries
+   */
+  LineShape(double m0, double width, double ma, double mb, unsigned L=0,
+	    double mmax=-1.0, double radius=3.0, unsigned ntable=4096);
+
+  ~LineShape() {}
+
+  /**
+   * Return the mass-dependent width
+   *
+   * @param m Mass
+   *
+   * @return Width (0 below threshold)
+   */
+  double get_width(double m) const;
+
+  /**
+   * Return the (unnormalised) density
+   *
+   * @param m Mass
+   *
+   * @return Density
+   */
+  double get_density(double m) const;
+
+  /**
+   * Sample a mass
+   *
+   * @param u Uniform random number in [0, 1)
+   *
+   * @return Mass
+   */
+  double sample(double u) const
+  {
+    double x(u * (_table.size() - 1));
+    unsigned i(x);
+    if (i + 1 >= _table.size()) return _table.back();
+    return _table[i] + (x - i) * (_table[i + 1] - _table[i]);
+  }
+
+  /**
+   * Sample several masses
+   *
+   * @param n Number of masses
+   * @param u Uniform random numbers in [0, 1)
+   * @param masses Returns masses
+   */
+  void sample(unsigned n, const double *u, double *masses) const;
+
+  /**
+   * Return nominal mass
+   *
+   * @return Mass in GeV/c²
+   */
+  double get_mass() const { return _m0; }
+
+  /**
+   * Return threshold (sum of the decay product masses)
+   *
+   * @return Mass in GeV/c²
+   */
+  double get_threshold() const { return _ma + _mb; }
+
+  /**
+   * Return upper mass cut
+   *
+   * @return Mass in GeV/c²
+   */
+  double get_max() const { return _mmax; }
+
+private:
+
+  /**
+   * Return Blatt–Weisskopf barrier factor squared
+   *
+   * @param q Break-up momentum
+   *
+   * @return B_L(q)²
+   */
+  double _barrier2(double q) const;
+
+  double _m0;			/**< Nominal mass */
+  double _width;		/**< Nominal width */
+  double _ma;			/**< Mass of the first decay product */
+  double _mb;			/**< Mass of the second decay product */
+  unsigned _L;			/**< Orbital angular momentum */
+  double _mmax;			/**< Upper mass cut */
+  double _radius;		/**< Blatt–Weisskopf radius */
+  double _q0;			/**< Break-up momentum at m0 */
+  std::vector<double> _table;	/**< Masses at equidistant quantiles */
+};
+
+#endif	// LINESHAPE_HXX
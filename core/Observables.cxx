@@ -0,0 +1,116 @@
+/**
+ * @file   Observables.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 10:31:44 2026
+ *
+ * @brief  Implementation of the observables
+ *
+ *
+ */
+
+// STL headers
+#include <cmath>
+#include <algorithm>
+
+// package headers
+#include "Observables.hxx"
+
+
+/**
+ * Return mass from a 4-momentum (-ve for space-like vectors)
+ *
+ * @param lv 4-momentum
+ *
+ * @return Mass
+ */
+static double lv_mass(const double *lv)
+{
+  double m2(lv[3]*lv[3] - lv[0]*lv[0] - lv[1]*lv[1] - lv[2]*lv[2]);
+  return m2 < 0.0 ? -std::sqrt(-m2) : std::sqrt(m2);
+}
+
+
+/**
+ * Return magnitude of the 3-momentum
+ *
+ * @param lv 4-momentum
+ *
+ * @return Momentum
+ */
+static double lv_p(const double *lv)
+{
+  return std::sqrt(lv[0]*lv[0] + lv[1]*lv[1] + lv[2]*lv[2]);
+}
+
+
+double MomentumObservable::operator()(const double *particles) const
+{
+  const double *lv(particles + 4 * _ipart);
+  if (_transverse) return std::sqrt(lv[0]*lv[0] + lv[1]*lv[1]);
+  return lv_p(lv);
+}
+
+
+double PseudorapidityObservable::operator()(const double *particles) const
+{
+  const double *lv(particles + 4 * _ipart);
+  double p(lv_p(lv));
+  if (not (p > std::fabs(lv[2]))) return lv[2] < 0.0 ? -1E10 : 1E10;
+  return 0.5 * std::log((p + lv[2]) / (p - lv[2]));
+}
+
+
+double HelicityObservable::operator()(const double *particles) const
+{
+  const double *dau(particles + 4 * _idau), *mother(particles + 4 * _imother);
+
+  // mother flight direction (z-axis for a mother at rest)
+  double pmother(lv_p(mother)), axis[3] = {0.0, 0.0, 1.0};
+  if (pmother > 0.0) {
+    for (unsigned i = 0; i < 3; ++i) axis[i] = mother[i] / pmother;
+  }
+
+  // boost the component along the flight direction
+  double beta(pmother / mother[3]), gamma(1.0 / std::sqrt(1.0 - beta*beta));
+  double ppar(dau[0]*axis[0] + dau[1]*axis[1] + dau[2]*axis[2]);
+  double pperp2(std::max(lv_p(dau) * lv_p(dau) - ppar*ppar, 0.0));
+  double pparstar(gamma * (ppar - beta * dau[3]));
+  double pstar(std::sqrt(pperp2 + pparstar*pparstar));
+  return pstar > 0.0 ? pparstar / pstar : 0.0;
+}
+
+
+double MassObservable::operator()(const double *particles) const
+{
+  const double *lv1(particles + 4 * _ipart1), *lv2(particles + 4 * _ipart2);
+  double sum[4] = {lv1[0] + lv2[0], lv1[1] + lv2[1], lv1[2] + lv2[2],
+		   lv1[3] + lv2[3]};
+  return lv_mass(sum);
+}
+
+
+double KFactorObservable::operator()(const double *particles) const
+{
+  const double *lv1(particles + 4 * _ipart1), *lv2(particles + 4 * _ipart2),
+    *mother(particles + 4 * _imother);
+
+  // second particle with the mass hypothesis
+  double e2(lv2[3]);
+  if (not (_mass2 < 0.0)) {
+    e2 = std::sqrt(lv2[0]*lv2[0] + lv2[1]*lv2[1] + lv2[2]*lv2[2] +
+		   _mass2*_mass2);
+  }
+  double reco[4] = {lv1[0] + lv2[0], lv1[1] + lv2[1], lv1[2] + lv2[2],
+		    lv1[3] + e2};
+
+  double kfactorp(lv_p(reco) / lv_p(mother));
+  double kfactorm(lv_mass(mother) / lv_mass(reco));
+  switch (_kind) {
+  case MOMENTUM:
+    return kfactorp;
+  case MASS:
+    return kfactorm;
+  default:
+    return kfactorp * kfactorm;
+  }
+}
@@ -0,0 +1,187 @@
+/**
+ * @file   Observables.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Wed Oct 21 09:52:30 2026
+ *
+ * @brief  Observables computed from generated events
+ *
+ *
+ */
+
+#ifndef OBSERVABLES_HXX
+#define OBSERVABLES_HXX
+
+
+/**
+ * Base class for observables computed from a generated event.
+ *
+ * Events are flat arrays of 4-momenta (px, py, pz, E) as filled by
+ * DecayGenCore::generate: the mother first, followed by the two
+ * daughters of each decay vertex.  Observables must not modify
+ * themselves when evaluated, so that one instance can be shared by
+ * several threads.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-21 Wed
+ *
+ */
+
+class Observable {
+public:
+
+  virtual ~Observable() {}
+
+  /**
+   * Evaluate observable
+   *
+   * @param particles 4-momenta of all particles in the event
+   *
+   * @return Value
+   */
+  virtual double operator()(const double *particles) const = 0;
+};
+
+
+/**
+ * Momentum (or transverse momentum) of a particle
+ */
+
+class MomentumObservable : public Observable {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param ipart Particle index (0 is the mother)
+   * @param transverse Use transverse momentum instead
+   */
+  MomentumObservable(unsigned ipart, bool transverse=false) :
+    _ipart(ipart), _transverse(transverse) {}
+
+  double operator()(const double *particles) const;
+
+private:
+
+  unsigned _ipart;		/**< Particle index */
+  bool _transverse;		/**< Transverse momentum */
+};
+
+
+/**
+ * Pseudorapidity of a particle
+ */
+
+class PseudorapidityObservable : public Observable {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param ipart Particle index (0 is the mother)
+   */
+  PseudorapidityObservable(unsigned ipart) : _ipart(ipart) {}
+
+  double operator()(const double *particles) const;
+
+private:
+
+  unsigned _ipart;		/**< Particle index */
+};
+
+
+/**
+ * Helicity angle: cosine of the angle between a daughter in the rest
+ * frame of its mother and the mother flight direction
+ */
+
+class HelicityObservable : public Observable {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param idau Daughter index
+   * @param imother Index of its mother
+   */
+  HelicityObservable(unsigned idau, unsigned imother) :
+    _idau(idau), _imother(imother) {}
+
+  double operator()(const double *particles) const;
+
+private:
+
+  unsigned _idau;		/**< Daughter index */
+  unsigned _imother;		/**< Mother index */
+};
+
+
+/**
+ * Invariant mass of a pair of particles
+ */
+
+class MassObservable : public Observable {
+public:
+
+  /**
+   * Constructor
+   *
+   * @param ipart1 Index of the first particle
+   * @param ipart2 Index of the second particle
+   */
+  MassObservable(unsigned ipart1, unsigned ipart2) :
+    _ipart1(ipart1), _ipart2(ipart2) {}
+
+  double operator()(const double *particles) const;
+
+private:
+
+  unsigned _ipart1;		/**< Index of the first particle */
+  unsigned _ipart2;		/**< Index of the second particle */
+};
+
+
+/**
+ * k-factor of a partially reconstructed decay
+ *
+ * The mother is reconstructed from two particles, the second of which
+ * is given a (possibly different) mass hypothesis, as in test.cc:
+ *
+ *   - MOMENTUM: p(reco) / p(mother)
+ *   - MASS: m(mother) / m(reco)
+ *   - BOTH: product of the two
+ */
+
+class KFactorObservable : public Observable {
+public:
+
+  /**
+   * k-factor definitions
+   */
+  enum Kind { MOMENTUM, MASS, BOTH };
+
+  /**
+   * Constructor
+   *
+   * @param ipart1 Index of the first particle
+   * @param ipart2 Index of the second particle
+   * @param mass2 Mass hypothesis for the second particle in GeV/c² (-ve to keep)
+   * @param kind k-factor definition
+   * @param imother Index of the true mother
+   */
+  KFactorObservable(unsigned ipart1, unsigned ipart2, double mass2,
+		    Kind kind=BOTH, unsigned imother=0) :
+    _ipart1(ipart1), _ipart2(ipart2), _imother(imother), _mass2(mass2),
+    _kind(kind) {}
+
+  double operator()(const double *particles) const;
+
+private:
+
+  unsigned _ipart1;		/**< Index of the first particle */
+  unsigned _ipart2;		/**< Index of the second particle */
+  unsigned _imother;		/**< Index of the true mother */
+  double _mass2;		/**< Mass hypothesis for the second particle */
+  Kind _kind;			/**< k-factor definition */
+};
+
+#endif	// OBSERVABLES_HXX
@@ -0,0 +1,275 @@
+/**
+ * @file   PipelineGen.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Thu Oct 22 11:03:58 2026
+ *
+ * @brief  Implementation of PipelineGen
+ *
+ *
+ */
+
+// STL headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+
+// Boost headers
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+// package headers
+#include "PipelineGen.hxx"
+#include "WallClock.hxx"
+
+
+PipelineGen::PipelineGen(const DecayGenCore &generator, unsigned capacity,
+			 unsigned batchsize, unsigned nlanes) :
+  _generator(generator), _stride(4 * _generator.get_nparticles()),
+  _batches(std::max(capacity / std::max(batchsize, 1u), 2u)),
+  _free(_batches.size()), _stop(false), _ntried(0)
+{
+  batchsize = std::max(batchsize, 1u);
+  for (unsigned i = 0; i < _batches.size(); ++i) {
+    _batches[i].particles.resize(batchsize * _stride, 0.0);
+    _batches[i].chid.resize(batchsize, 0);
+    _batches[i].weight.resize(batchsize, 0.0);
+    _batches[i].ntried.resize(batchsize, 0);
+    _batches[i].size = 0;
+  }
+
+  // a lane may hold every batch, and the end of stream marker
+  nlanes = std::max(nlanes, 1u);
+  for (unsigned i = 0; i < nlanes; ++i) {
+    _lanes.push_back(new Lane(_batches.size() + 1));
+  }
+
+  StageStats stats = {"sampling", 0, 0.0, 0.0};
+  _stats.push_back(stats);
+  const char *names[2] = {"decay", "acceptance"};
+  for (unsigned j = 0; j < 2; ++j) {
+    for (unsigned i = 0; i < nlanes; ++i) {
+      std::ostringstream name;
+      name << names[j];
+      if (nlanes > 1) name << " " << i;
+      stats.name = name.str();
+      _stats.push_back(stats);
+    }
+  }
+  stats.name = "serialisation";
+  _stats.push_back(stats);
+}
+
+
+PipelineGen::~PipelineGen()
+{
+  for (unsigned i = 0; i < _lanes.size(); ++i) {
+    delete _lanes[i];
+  }
+}
+
+
+PipelineGen::Batch* PipelineGen::_pop(Queue &queue, StageStats &stats)
+{
+  Batch *batch(NULL);
+  if (queue.pop(batch)) return batch;
+
+  double start(walltime());
+  while (not queue.pop(batch)) {
+    boost::this_thread::yield();
+  }
+  stats.stalltime += walltime() - start;
+  return batch;
+}
+
+
+void PipelineGen::_push(Queue &queue, Batch *batch, StageStats &stats)
+{
+  if (queue.push(batch)) return;
+
+  double start(walltime());
+  while (not queue.push(batch)) {
+    boost::this_thread::yield();
+  }
+  stats.stalltime += walltime() - start;
+  return;
+}
+
+
+unsigned long PipelineGen::generate(unsigned long nevents,
+				    const TemplateSampler &psampler,
+				    const TemplateSampler *etasampler,
+				    EventSink &sink, unsigned seed)
+{
+  // all batches are free at the start
+  Batch *batch(NULL);
+  while (_free.pop(batch)) {}
+  for (unsigned i = 0; i < _batches.size(); ++i) {
+    _free.push(&_batches[i]);
+  }
+  for (unsigned i = 0; i < _stats.size(); ++i) {
+    _stats[i].nevents = 0;
+    _stats[i].walltime = 0.0;
+    _stats[i].stalltime = 0.0;
+  }
+  _ntried = 0;
+  _stop = (nevents == 0);
+
+  boost::thread_group threads;
+  threads.create_thread(boost::bind(&PipelineGen::_sample, this, &psampler,
+				    etasampler, seed + 1));
+  for (unsigned i = 0; i < _lanes.size(); ++i) {
+    threads.create_thread(boost::bind(&PipelineGen::_decay, this, i,
+				      seed + 2 * i));
+    threads.create_thread(boost::bind(&PipelineGen::_accept, this, i));
+  }
+  threads.create_thread(boost::bind(&PipelineGen::_serialise, this, nevents,
+				    &sink));
+  threads.join_all();
+
+  return _ntried;
+}
+
+
+void PipelineGen::_sample(const TemplateSampler *psampler,
+			  const TemplateSampler *etasampler, unsigned seed)
+{
+  StageStats &stats(_stats[0]);
+  double start(walltime());
+
+  DecayGenCore generator(_generator);
+  generator.set_seed(seed);
+
+  // batches are handed out to the lanes round-robin
+  unsigned lane(0);
+  while (not _stop) {
+    Batch *batch(_pop(_free, stats));
+    batch->size = batch->chid.size();
+    for (unsigned evt = 0; evt < batch->size; ++evt) {
+      double *particles(&batch->particles[evt * _stride]);
+      batch->ntried[evt] = 0;
+      do {
+	batch->ntried[evt]++;
+      } while (not generator.sample_mother(*psampler, etasampler, particles));
+      batch->chid[evt] = generator.choose_channel();
+      batch->weight[evt] = 1.0;
+    }
+    _push(_lanes[lane]->sampled, batch, stats);
+    lane = (lane + 1) % _lanes.size();
+    stats.nevents += batch->size;
+  }
+  // end of stream, in the order the last stage reads the lanes
+  for (unsigned i = 0; i < _lanes.size(); ++i) {
+    _push(_lanes[lane]->sampled, NULL, stats);
+    lane = (lane + 1) % _lanes.size();
+  }
+
+  stats.walltime = walltime() - start;
+  return;
+}
+
+
+void PipelineGen::_decay(unsigned lane, unsigned seed)
+{
+  StageStats &stats(_stats[1 + lane]);
+  Lane &queues(*_lanes[lane]);
+  double start(walltime());
+
+  DecayGenCore generator(_generator);
+  generator.set_seed(seed);
+
+  Batch *batch(NULL);
+  while ((batch = _pop(queues.sampled, stats))) {
+    for (unsigned evt = 0; evt < batch->size; ++evt) {
+      batch->weight[evt] = generator.decay(batch->chid[evt],
+					   &batch->particles[evt * _stride]);
+    }
+    _push(queues.decayed, batch, stats);
+    stats.nevents += batch->size;
+  }
+  _push(queues.decayed, NULL, stats);
+
+  stats.walltime = walltime() - start;
+  return;
+}
+
+
+void PipelineGen::_accept(unsigned lane)
+{
+  StageStats &stats(_stats[1 + _lanes.size() + lane]);
+  Lane &queues(*_lanes[lane]);
+  double start(walltime());
+
+  Batch *batch(NULL);
+  while ((batch = _pop(queues.decayed, stats))) {
+    for (unsigned evt = 0; evt < batch->size; ++evt) {
+      if (batch->weight[evt] > 0 and
+	  not _generator.in_acceptance(batch->chid[evt],
+				       &batch->particles[evt * _stride])) {
+	batch->weight[evt] = -100;
+      }
+    }
+    _push(queues.checked, batch, stats);
+    stats.nevents += batch->size;
+  }
+  _push(queues.checked, NULL, stats);
+
+  stats.walltime = walltime() - start;
+  return;
+}
+
+
+void PipelineGen::_serialise(unsigned long nevents, EventSink *sink)
+{
+  StageStats &stats(_stats.back());
+  double start(walltime());
+
+  // drain the pipeline after the last event, recycling all batches;
+  // events after the last accepted one are not counted as tried.
+  // Lanes are read round-robin like the sampling stage fills them,
+  // until every lane has ended.
+  unsigned lane(0), nended(0);
+  while (nended < _lanes.size()) {
+    Batch *batch(_pop(_lanes[lane]->checked, stats));
+    lane = (lane + 1) % _lanes.size();
+    if (not batch) {
+      nended++;
+      continue;
+    }
+    for (unsigned evt = 0; evt < batch->size and stats.nevents < nevents;
+	 ++evt) {
+      _ntried += batch->ntried[evt];
+      if (not (batch->weight[evt] > 0)) continue;
+      sink->write(&batch->particles[evt * _stride],
+		  _generator.get_nparticles(batch->chid[evt]),
+		  batch->chid[evt], batch->weight[evt]);
+      if (++stats.nevents == nevents) _stop = true;
+    }
+    _push(_free, batch, stats);
+  }
+
+  stats.walltime = walltime() - start;
+  return;
+}
+
+
+void PipelineGen::print_stats() const
+{
+  std::cout << std::setw(14) << std::left << "Stage"
+	    << std::setw(12) << std::right << "events"
+	    << std::setw(14) << "rate [1/s]"
+	    << std::setw(14) << "stalled [%]" << std::endl;
+  for (unsigned i = 0; i < _stats.size(); ++i) {
+    const StageStats &stats(_stats[i]);
+    double busy(stats.walltime - stats.stalltime);
+    std::cout << std::setw(14) << std::left << stats.name
+	      << std::setw(12) << std::right << stats.nevents
+	      << std::setw(14) << std::setprecision(4)
+	      << (busy > 0 ? stats.nevents / busy : 0.0)
+	      << std::setw(14) << std::setprecision(3)
+	      << (stats.walltime > 0 ?
+		  100 * stats.stalltime / stats.walltime : 0.0)
+	      << std::endl;
+  }
+  return;
+}
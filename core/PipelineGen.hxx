@@ -0,0 +1,237 @@
+/**
+ * @file   PipelineGen.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Thu Oct 22 10:12:37 2026
+ *
+ * @brief  Pipelined event generation on several threads
+ *
+ *
+ */
+
+#ifndef PIPELINEGEN_HXX
+#define PIPELINEGEN_HXX
+
+// STL headers
+#include <vector>
+#include <string>
+
+// Boost headers
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/noncopyable.hpp>
+
+// package headers
+#include "DecayGenCore.hxx"
+#include "TemplateSampler.hxx"
+
+
+/**
+ * Destination of accepted events (e.g. a file)
+ *
+ * Called from the last stage of PipelineGen, i.e. from a single
+ * thread other than the caller's.
+ */
+
+class EventSink {
+public:
+
+  virtual ~EventSink() {}
+
+  /**
+   * Write one event
+   *
+   * @param particles 4-momenta of all particles (see DecayGenCore::generate)
+   * @param nparticles Number of particles
+   * @param chid Decay channel id
+   * @param weight Event weight
+   */
+  virtual void write(const double *particles, unsigned nparticles,
+		     unsigned chid, double weight) = 0;
+};
+
+
+/**
+ * This class generates events in a pipeline of four stages:
+ *
+ *   1. sampling: mother kinematics and decay channel
+ *   2. decay: decay kinematics (DecayGenCore::decay)
+ *   3. acceptance: DecayGenCore::in_acceptance
+ *   4. serialisation: accepted events are passed to an EventSink
+ *
+ * Stages are connected by bounded lock-free single producer, single
+ * consumer ring buffers, which pass batches of events rather than
+ * single events, so the queue operations are amortised over the
+ * batch.  A fixed number of batches circulates through the stages,
+ * the last stage returning them to the first one; a stage waits when
+ * its input is empty or when no free batch is left, so a slow stage
+ * throttles the others (backpressure) and memory use is fixed.
+ * Rejected events are passed on to the last stage, which recycles
+ * their batch.
+ *
+ * Sampling and serialisation run on one thread each.  Decay and
+ * acceptance, the expensive stages, run in one or more lanes: each
+ * lane has its own decay and acceptance thread, and its own queues,
+ * so every queue still has a single producer and a single consumer.
+ * The sampling stage hands out batches to the lanes round-robin, and
+ * the serialisation stage collects them in the same order, so events
+ * are written in the order they were sampled.  Each lane decays with
+ * its own random number generator, so the events depend on the
+ * number of lanes, but not on thread timing.
+ *
+ * Each stage (and each lane) counts the events it processed and the
+ * time it was stalled waiting for input, so the bottleneck is the
+ * stage that is never stalled (see print_stats).
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-22 Thu
+ *
+ */
+
+class PipelineGen : private boost::noncopyable {
+public:
+
+  /**
+   * Per stage counters
+   */
+  struct StageStats {
+    std::string name;		/**< Stage name */
+    unsigned long nevents;	/**< Processed events */
+    double walltime;		/**< Wall time in s */
+    double stalltime;		/**< Time waiting for input or free slots in s */
+  };
+
+  /**
+   * Constructor
+   *
+   * The generator is copied, so options (e.g. early rejection) have
+   * to be set before.
+   *
+   * @param generator Generator with the decay channels
+   * @param capacity Number of event slots in the pipeline
+   * @param batchsize Number of events per batch (at least two batches are used)
+   * @param nlanes Number of decay and acceptance lanes (threads each)
+   */
+  PipelineGen(const DecayGenCore &generator, unsigned capacity=1024,
+	      unsigned batchsize=64, unsigned nlanes=1);
+
+  ~PipelineGen();
+
+  /**
+   * Generate accepted events and pass them to a sink
+   *
+   * @param nevents Number of accepted events
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   * @param sink Destination of the accepted events
+   * @param seed Seed (the sampling stage uses seed + 1, decay lane i seed + 2i)
+   *
+   * @return Number of tried events, up to the last accepted one
+   */
+  unsigned long generate(unsigned long nevents,
+			 const TemplateSampler &psampler,
+			 const TemplateSampler *etasampler,
+			 EventSink &sink, unsigned seed=4357);
+
+  /**
+   * Return stage counters of the last call to generate
+   *
+   * @return Counters, in pipeline order (sampling, decay lanes,
+   *         acceptance lanes, serialisation)
+   */
+  const std::vector<StageStats>& get_stats() const { return _stats; }
+
+  /**
+   * Print throughput of each stage
+   */
+  void print_stats() const;
+
+private:
+
+  /**
+   * Batch of event slots
+   */
+  struct Batch {
+    std::vector<double> particles; /**< 4-momenta of all particles, per event */
+    std::vector<unsigned> chid;	   /**< Decay channel id */
+    std::vector<double> weight;	   /**< Event weight (≤ 0 if rejected) */
+    std::vector<unsigned> ntried;  /**< Sampled mothers (incl. η rejection) */
+    unsigned size;		   /**< Number of events */
+  };
+
+  typedef boost::lockfree::spsc_queue<Batch*> Queue; /**< Ring buffer */
+
+  /**
+   * Queues of one decay and acceptance lane
+   */
+  struct Lane : private boost::noncopyable {
+    Lane(unsigned capacity) :
+      sampled(capacity), decayed(capacity), checked(capacity) {}
+
+    Queue sampled;		/**< Sampling → decay */
+    Queue decayed;		/**< Decay → acceptance */
+    Queue checked;		/**< Acceptance → serialisation */
+  };
+
+  /**
+   * Take a batch from a queue, waiting until there is one
+   *
+   * @param queue Input queue
+   * @param stats Stage counters
+   *
+   * @return Batch (NULL marks the end of the stream)
+   */
+  static Batch* _pop(Queue &queue, StageStats &stats);
+
+  /**
+   * Put a batch in a queue, waiting until there is space
+   *
+   * @param queue Output queue
+   * @param batch Batch
+   * @param stats Stage counters
+   */
+  static void _push(Queue &queue, Batch *batch, StageStats &stats);
+
+  /**
+   * Sampling stage
+   *
+   * @param psampler Template for 3-momentum of the mother particle
+   * @param etasampler Template for pseudorapidity(η) of the mother particle
+   * @param seed Seed
+   */
+  void _sample(const TemplateSampler *psampler,
+	       const TemplateSampler *etasampler, unsigned seed);
+
+  /**
+   * Decay stage of a lane
+   *
+   * @param lane Lane index
+   * @param seed Seed
+   */
+  void _decay(unsigned lane, unsigned seed);
+
+  /**
+   * Acceptance stage of a lane
+   *
+   * @param lane Lane index
+   */
+  void _accept(unsigned lane);
+
+  /**
+   * Serialisation stage
+   *
+   * @param nevents Number of accepted events
+   * @param sink Destination of the accepted events
+   */
+  void _serialise(unsigned long nevents, EventSink *sink);
+
+  DecayGenCore _generator;	/**< Generator with decay channels */
+  unsigned _stride;		/**< Doubles per event (4 × particles) */
+  std::vector<Batch> _batches;	/**< Event slots */
+  Queue _free;			/**< Free batches (last → first stage) */
+  std::vector<Lane*> _lanes;	/**< Decay and acceptance lanes */
+  boost::atomic<bool> _stop;	/**< Enough events accepted */
+  unsigned long _ntried;	/**< Tried events up to the last accepted one */
+  std::vector<StageStats> _stats; /**< Stage counters */
+};
+
+#endif	// PIPELINEGEN_HXX
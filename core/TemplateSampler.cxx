@@ -0,0 +1,59 @@
+/**
+ * @file   TemplateSampler.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 11:25:16 2026
+ *
+ * @brief  Implementation of TemplateSampler
+ *
+ *
+ */
+
+// STL headers
+#include <algorithm>
+
+// package headers
+#include "TemplateSampler.hxx"
+
+
+TemplateSampler::TemplateSampler(unsigned nbins, double xmin, double xmax,
+				 const double *contents) :
+  _edges(nbins + 1, xmin)
+{
+  for (unsigned i = 0; i <= nbins; ++i) {
+    _edges[i] = xmin + i * (xmax - xmin) / nbins;
+  }
+  _build_cdf(contents);
+}
+
+
+TemplateSampler::TemplateSampler(unsigned nbins, const double *edges,
+				 const double *contents) :
+  _edges(edges, edges + nbins + 1)
+{
+  _build_cdf(contents);
+}
+
+
+void TemplateSampler::_build_cdf(const double *contents)
+{
+  const unsigned nbins(_edges.size() - 1);
+  _cdf.resize(nbins, 0.0);
+
+  double sum(0.0);
+  for (unsigned i = 0; i < nbins; ++i) {
+    sum += std::max(contents[i], 0.0);
+    _cdf[i] = sum;
+  }
+  if (sum > 0.0) {
+    for (unsigned i = 0; i < nbins; ++i) _cdf[i] /= sum;
+  }
+  return;
+}
+
+
+double TemplateSampler::sample(double u1, double u2) const
+{
+  unsigned bin(std::upper_bound(_cdf.begin(), _cdf.end(), u1) - _cdf.begin());
+  bin = std::min(bin, unsigned(_cdf.size() - 1));
+  return _edges[bin] + u2 * (_edges[bin + 1] - _edges[bin]);
+}
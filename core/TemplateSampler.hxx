@@ -0,0 +1,87 @@
+/**
+ * @file   TemplateSampler.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Tue Oct 20 11:02:48 2026
+ *
+ * @brief  ROOT independent sampling from a binned template
+ *
+ *
+ */
+
+#ifndef TEMPLATESAMPLER_HXX
+#define TEMPLATESAMPLER_HXX
+
+// STL headers
+#include <vector>
+
+
+/**
+ * This class samples random numbers from a binned distribution
+ * (template) with the inverse of its cumulative distribution.
+ *
+ * A bin is chosen according to its content, and the value is uniform
+ * within the bin; this is the same as TH1::GetRandom.  The class does
+ * not depend on ROOT and is used by DecayGenCore to sample the mother
+ * kinematics.
+ *
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date 2026-10-20 Tue
+ *
+ */
+
+class TemplateSampler {
+public:
+
+  /**
+   * Constructor with uniform binning
+   *
+   * @param nbins Number of bins
+   * @param xmin Lower edge of the first bin
+   * @param xmax Upper edge of the last bin
+   * @param contents Array of nbins bin contents (-ve contents are ignored)
+   */
+  TemplateSampler(unsigned nbins, double xmin, double xmax,
+		  const double *contents);
+
+  /**
+   * Constructor with variable binning
+   *
+   * @param nbins Number of bins
+   * @param edges Array of nbins + 1 bin edges
+   * @param contents Array of nbins bin contents (-ve contents are ignored)
+   */
+  TemplateSampler(unsigned nbins, const double *edges, const double *contents);
+
+  ~TemplateSampler() {}
+
+  /**
+   * Sample a value
+   *
+   * @param u1 Uniform random number in [0, 1) to choose the bin
+   * @param u2 Uniform random number in [0, 1) for the position in the bin
+   *
+   * @return Sampled value
+   */
+  double sample(double u1, double u2) const;
+
+  /**
+   * Return if the template has any (positive) entries
+   *
+   * @return Status
+   */
+  bool is_valid() const { return not _cdf.empty() and _cdf.back() > 0.0; }
+
+private:
+
+  /**
+   * Build the cumulative distribution
+   *
+   * @param contents Array of bin contents
+   */
+  void _build_cdf(const double *contents);
+
+  std::vector<double> _edges;	/**< Bin edges */
+  std::vector<double> _cdf;	/**< Cumulative distribution, normalised to 1 */
+};
+
+#endif	// TEMPLATESAMPLER_HXX
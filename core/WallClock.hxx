@@ -0,0 +1,33 @@
+/**
+ * @file   WallClock.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Fri Oct 23 09:41:05 2026
+ *
+ * @brief  Wall clock time for throughput measurements
+ *
+ *
+ */
+
+#ifndef WALLCLOCK_HXX
+#define WALLCLOCK_HXX
+
+// Boost headers
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+
+/**
+ * Return wall clock time
+ *
+ * Unlike std::clock, this is meaningful when several threads are
+ * running.
+ *
+ * @return Time in s (since an arbitrary epoch)
+ */
+inline double walltime()
+{
+  static const boost::posix_time::ptime epoch(boost::gregorian::date(2000, 1, 1));
+  return (boost::posix_time::microsec_clock::universal_time() - epoch)
+    .total_microseconds() * 1E-6;
+}
+
+#endif	// WALLCLOCK_HXX
@@ -0,0 +1,250 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "DecayGenCore.hxx"
+#include "TemplateSampler.hxx"
+#include "PipelineGen.hxx"
+#include "LineShape.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), KMASS(493.677),
+  PIMASS(139.57018), DSSTMASS(2112.34),
+  DSSTWIDTH(1.9);		// upper limit
+
+
+/**
+ * Write events as raw doubles: channel, weight, 4-momenta (the number
+ * of particles depends on the channel)
+ */
+class BinaryFileSink : public EventSink {
+public:
+  BinaryFileSink(const char *fname) : _file(fname, std::ios::binary) {}
+
+  void write(const double *particles, unsigned nparticles, unsigned chid,
+	     double weight)
+  {
+    double header[2] = {double(chid), weight};
+    _file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    _file.write(reinterpret_cast<const char*>(particles),
+		4 * nparticles * sizeof(double));
+  }
+
+  bool good() const { return _file.good(); }
+
+private:
+  std::ofstream _file;
+};
+
+
+/**
+ * Check the Ds* masses of the DsstPiLS mode against its line shape
+ *
+ * The Ds* (particle 1) mass of events of the Ds γ channel (0) is
+ * compared with the cumulative distribution of the line shape,
+ * integrated from its density, and events of the Ds π channel (1)
+ * have to be rejected exactly when the Ds* is below the Ds π
+ * threshold.  Differences above 5σ fail.
+ */
+class LineShapeCheck {
+public:
+  LineShapeCheck(const LineShape &shape, double threshold) :
+    _shape(shape), _threshold(threshold), _nrejected(0), _nbelow(0)
+  {
+    const double m0(shape.get_mass()), width(DSSTWIDTH * 1E-3);
+    _points.push_back(m0 - width);
+    _points.push_back(m0);
+    _points.push_back(m0 + width);
+    _points.push_back(threshold);
+    _counts.resize(_points.size(), 0);
+    _ntried[0] = _ntried[1] = 0;
+  }
+
+  void fill(unsigned chid, double weight, const double *particles)
+  {
+    const double *p(particles + 4);
+    double mass(std::sqrt(p[3]*p[3] - p[0]*p[0] - p[1]*p[1] - p[2]*p[2]));
+    _ntried[chid]++;
+    if (chid == 0) {
+      for (unsigned i = 0; i < _points.size(); ++i) {
+	if (mass < _points[i]) _counts[i]++;
+      }
+    } else if (weight == -1.0) {
+      _nrejected++;
+    } else if (mass < _threshold) {
+      _nbelow++;
+    }
+  }
+
+  bool check() const
+  {
+    bool pass(true);
+    std::cout << "Ds* mass (Ds γ), fraction below:" << std::endl;
+    for (unsigned i = 0; i < _points.size(); ++i) {
+      pass &= _compare(_points[i], _counts[i], _ntried[0]);
+    }
+    std::cout << "Ds π rejected below threshold:" << std::endl;
+    pass &= _compare(_threshold, _nrejected, _ntried[1]);
+    std::cout << "Ds π events below threshold not rejected: " << _nbelow
+	      << std::endl;
+    return pass and _nbelow == 0 and _ntried[0] > 0 and _ntried[1] > 0;
+  }
+
+private:
+  /// Line shape probability below m, integrated from the density
+  double _cdf(double m) const
+  {
+    const double mmin(_shape.get_threshold()), mmax(_shape.get_max());
+    const unsigned ngrid(100000);
+    const double step((mmax - mmin) / ngrid);
+    double total(0.0), below(0.0), prev(_shape.get_density(mmin));
+    for (unsigned i = 1; i <= ngrid; ++i) {
+      double cur(_shape.get_density(mmin + i * step));
+      total += 0.5 * (prev + cur) * step;
+      if (mmin + i * step <= m) below = total;
+      prev = cur;
+    }
+    return below / total;
+  }
+
+  bool _compare(double m, unsigned long n, unsigned long ntot) const
+  {
+    double expected(_cdf(m)), observed(double(n) / ntot),
+      sigma(std::sqrt(expected * (1 - expected) / ntot));
+    bool pass(std::fabs(observed - expected) < 5 * sigma + 1E-4);
+    std::cout << "  m < " << m * 1E3 << " MeV/c²: " << observed
+	      << " (expected " << expected << ") "
+	      << (pass ? "ok" : "FAIL") << std::endl;
+    return pass;
+  }
+
+  const LineShape &_shape;
+  double _threshold;
+  std::vector<double> _points;
+  std::vector<unsigned long> _counts;
+  unsigned long _ntried[2], _nrejected, _nbelow;
+};
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " <nevents> <mode> [outfile [nlanes]]"
+    " # args are case sensitive" << std::endl;
+  std::cout << "ROOT independent generator, mother p and η are flat"
+    " in [0, 300] GeV/c and [1, 6]" << std::endl;
+  std::cout << "With outfile, events are generated in a pipeline and"
+    " written as raw doubles" << std::endl;
+  std::cout << "nlanes is the number of decay and acceptance lanes of the"
+    " pipeline (default 1)" << std::endl;
+  std::cout << "Mode DsstPiLS is DsstPi with a Breit–Wigner Ds*, and"
+    " checks its mass distribution (no outfile)" << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc < 3 or argc > 5) {
+    std::cout << "Wrong number of arguments!" << std::endl;
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned nevents(atol(argv[1]));
+  std::string mode(argv[2]);
+  const bool lineshape("DsstPiLS" == mode);
+  if (lineshape) {
+    if (argc > 3) {
+      std::cout << "No outfile with mode " << mode << std::endl;
+      usage(argv[0]);
+      return -1;
+    }
+    mode = "DsstPi";
+  }
+
+  // flat templates, same binning as generator
+  std::vector<double> flat(100, 1.0);
+  TemplateSampler Bsmomp(100, 0.0, 300.0, &flat[0]);
+  TemplateSampler Bsmomn(100, 1.0, 6.0, &flat[0]);
+
+  std::vector<double> masses;
+  masses.push_back(BSMASS * 1E-3);
+  if ("DsK" == mode) {
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(KMASS * 1E-3);
+  } else if ("DsPi" == mode) {
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+  } else if ("DsstPi" == mode) {
+    masses.push_back(DSSTMASS * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(0.0);
+  } else {
+    std::cout << "Unknown mode: " << mode << std::endl;
+    usage(argv[0]);
+    return -1;
+  }
+
+  std::vector<double> masses2;
+  if ("DsstPi" == mode) {
+    masses2.push_back(BSMASS * 1E-3);
+    masses2.push_back(DSSTMASS * 1E-3);
+    masses2.push_back(PIMASS * 1E-3);
+    masses2.push_back(DSMASS * 1E-3);
+    masses2.push_back(PIMASS * 1E-3);
+  }
+
+  DecayGenCore generator(&masses[0], masses.size());
+  if ("DsstPi" == mode) {
+    generator.add_decay_channel(&masses2[0], masses2.size(), 0.05);
+  }
+  generator.print();
+
+  // Ds* → Ds γ is a magnetic dipole transition (L = 1)
+  LineShape dsst(DSSTMASS * 1E-3, DSSTWIDTH * 1E-3, DSMASS * 1E-3, 0.0, 1);
+  if (lineshape and generator.add_line_shape(dsst) == 0) return -1;
+
+  // pipelined generation, writing to a file
+  if (argc > 3) {
+    BinaryFileSink sink(argv[3]);
+    if (not sink.good()) {
+      std::cout << "Could not open " << argv[3] << std::endl;
+      return -1;
+    }
+    PipelineGen pipeline(generator, 1024, 64, argc == 5 ? atoi(argv[4]) : 1);
+    unsigned long ntried(pipeline.generate(nevents, Bsmomp, &Bsmomn, sink));
+    std::cout << "Tried: " << ntried << ", accepted: " << nevents << std::endl;
+    pipeline.print_stats();
+    return 0;
+  }
+
+  // generate and print summary
+  std::clock_t start(std::clock());
+  std::vector<double> particles(4 * generator.get_nparticles());
+  LineShapeCheck lscheck(dsst, (DSMASS + PIMASS) * 1E-3);
+  unsigned long ntried(0), naccepted(0);
+  while (naccepted < nevents) {
+    ntried++;
+    if (not generator.sample_mother(Bsmomp, &Bsmomn, &particles[0])) continue;
+    unsigned chid(generator.choose_channel());
+    double weight(generator.generate(chid, &particles[0]));
+    if (weight > 0) naccepted++;
+    if (lineshape) lscheck.fill(chid, weight, &particles[0]);
+  }
+  double cputime(double(std::clock() - start) / CLOCKS_PER_SEC);
+
+  std::cout << "Tried: " << ntried << ", accepted: " << naccepted
+	    << ", CPU time: " << cputime << " s" << std::endl;
+  if (lineshape) {
+    generator.print_line_shape_stats();
+    bool pass(lscheck.check());
+    std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "DecayGenCore.hxx"
+#include "HypothesisGen.hxx"
+#include "TemplateSampler.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), KMASS(493.677),
+  PIMASS(139.57018), DSSTMASS(2112.34);
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " [<nevents> [bench]]" << std::endl;
+  std::cout << "Compares the first hypothesis of HypothesisGen with"
+    " DecayGenCore at the same seed" << std::endl;
+  std::cout << "With bench, prints the cost of 1 to 16 hypotheses"
+    " instead" << std::endl;
+}
+
+
+/**
+ * Return the particle masses of a mode, in GeV/c²
+ *
+ * @param mode DsK, DsPi or DsstPi (Ds* → Ds γ)
+ * @param dsmass Ds mass in MeV/c²
+ *
+ * @return Particle mass array
+ */
+std::vector<double> mode_masses(std::string mode, double dsmass=DSMASS)
+{
+  std::vector<double> masses;
+  masses.push_back(BSMASS * 1E-3);
+  if ("DsK" == mode) {
+    masses.push_back(dsmass * 1E-3);
+    masses.push_back(KMASS * 1E-3);
+  } else if ("DsPi" == mode) {
+    masses.push_back(dsmass * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+  } else {
+    masses.push_back(DSSTMASS * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+    masses.push_back(dsmass * 1E-3);
+    masses.push_back(0.0);
+  }
+  return masses;
+}
+
+
+/**
+ * Generate events with DecayGenCore and with the first hypothesis of
+ * HypothesisGen, and compare them
+ *
+ * Weights have to agree in sign, and 4-momenta of accepted events to
+ * 1E-9 relative.
+ *
+ * @param mode Decay mode
+ * @param nevents Number of tried events
+ * @param psampler Mother momentum template
+ * @param etasampler Mother η template
+ * @param full Use the full acceptance definition
+ *
+ * @return Number of events that differ
+ */
+unsigned long compare(std::string mode, unsigned long nevents,
+		      const TemplateSampler &psampler,
+		      const TemplateSampler &etasampler, bool full)
+{
+  std::vector<double> masses(mode_masses(mode));
+  DecayGenCore core(&masses[0], masses.size());
+  HypothesisGen hypotheses(&masses[0], masses.size());
+  // a second hypothesis, so the first one is not a special case
+  std::vector<double> masses2(mode_masses(mode, DSMASS + 10.0));
+  hypotheses.add_hypothesis(&masses2[0], masses2.size());
+  core.set_full_acceptance(full);
+  hypotheses.set_full_acceptance(full);
+  core.set_seed(4357);
+  hypotheses.set_seed(4357);
+
+  const unsigned nparticles(core.get_nparticles(0));
+  std::vector<double> expected(4 * nparticles),
+    particles(4 * nparticles * hypotheses.get_nhypotheses()),
+    weights(hypotheses.get_nhypotheses());
+  unsigned long ndiff(0), naccepted(0);
+  for (unsigned long evt = 0; evt < nevents; ++evt) {
+    core.sample_mother(psampler, &etasampler, &expected[0]);
+    double weight(core.generate(0, &expected[0]));
+    hypotheses.generate(psampler, &etasampler, &particles[0], &weights[0]);
+
+    bool same((weight > 0) == (weights[0] > 0));
+    for (unsigned i = 0; same and weight > 0 and i < expected.size(); ++i) {
+      same = std::fabs(particles[i] - expected[i]) <=
+	1E-9 * std::fabs(expected[i]) + 1E-12;
+    }
+    if (weight > 0) naccepted++;
+    if (not same) ndiff++;
+  }
+
+  std::cout << mode << (full ? " (full acceptance)" : "") << ": " << naccepted << " of " << nevents
+	    << " events accepted, " << ndiff << " differ" << std::endl;
+  return ndiff;
+}
+
+
+/**
+ * Print CPU time per event for 1 to 16 hypotheses, compared with
+ * generating each hypothesis separately with DecayGenCore
+ *
+ * @param mode Decay mode
+ * @param nevents Number of tried events per measurement
+ * @param psampler Mother momentum template
+ * @param etasampler Mother η template
+ */
+void bench(std::string mode, unsigned long nevents,
+	   const TemplateSampler &psampler, const TemplateSampler &etasampler)
+{
+  std::cout << mode << ", " << nevents << " events, CPU time per event:"
+	    << std::endl;
+  std::cout << "  N  HypothesisGen (ns)  vs N=1  N x DecayGenCore (ns)"
+	    << std::endl;
+
+  double t1(0.0);
+  for (unsigned nhypo = 1; nhypo <= 16; nhypo *= 2) {
+    // Ds mass hypotheses 1 MeV/c² apart
+    std::vector<double> masses(mode_masses(mode));
+    HypothesisGen hypotheses(&masses[0], masses.size());
+    std::vector<DecayGenCore> cores(1, DecayGenCore(&masses[0], masses.size()));
+    for (unsigned h = 1; h < nhypo; ++h) {
+      masses = mode_masses(mode, DSMASS + h);
+      hypotheses.add_hypothesis(&masses[0], masses.size());
+      cores.push_back(DecayGenCore(&masses[0], masses.size()));
+    }
+
+    std::vector<double> particles(4 * hypotheses.get_nparticles() * nhypo),
+      weights(nhypo);
+    unsigned long naccepted(0);
+    std::clock_t start(std::clock());
+    for (unsigned long evt = 0; evt < nevents; ++evt) {
+      naccepted += hypotheses.generate(psampler, &etasampler, &particles[0],
+				       &weights[0]);
+    }
+    double thypo(double(std::clock() - start) / CLOCKS_PER_SEC);
+
+    start = std::clock();
+    for (unsigned h = 0; h < nhypo; ++h) {
+      for (unsigned long evt = 0; evt < nevents; ++evt) {
+	cores[h].sample_mother(psampler, &etasampler, &particles[0]);
+	if (cores[h].generate(0, &particles[0]) > 0) naccepted++;
+      }
+    }
+    double tcore(double(std::clock() - start) / CLOCKS_PER_SEC);
+
+    if (nhypo == 1) t1 = thypo;
+    std::cout << std::setw(3) << nhypo << std::fixed << std::setprecision(1)
+	      << std::setw(20) << 1E9 * thypo / nevents
+	      << std::setw(8) << thypo / t1
+	      << std::setw(23) << 1E9 * tcore / nevents
+	      << (naccepted ? "" : " (nothing accepted)") << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+  }
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc > 3 or (argc == 3 and std::string("bench") != argv[2])) {
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned long nevents(argc > 1 ? atol(argv[1]) : 100000);
+
+  // flat templates, same binning as coregen
+  std::vector<double> flat(100, 1.0);
+  TemplateSampler Bsmomp(100, 0.0, 300.0, &flat[0]);
+  TemplateSampler Bsmomn(100, 1.0, 6.0, &flat[0]);
+
+  const char *modes[3] = {"DsK", "DsPi", "DsstPi"};
+  if (argc == 3) {
+    for (unsigned i = 0; i < 3; ++i) bench(modes[i], nevents, Bsmomp, Bsmomn);
+    return 0;
+  }
+
+  unsigned long ndiff(0);
+  for (unsigned i = 0; i < 6; ++i) {
+    ndiff += compare(modes[i % 3], nevents, Bsmomp, Bsmomn, i >= 3);
+  }
+  std::cout << (ndiff ? "FAIL" : "PASS") << ": " << ndiff
+	    << " event(s) differ." << std::endl;
+  return ndiff ? 1 : 0;
+}
@@ -6,9 +6,10 @@
 #include <TFile.h>
 #include <TH1D.h>
 #include <TTree.h>
-#include <TPad.h>
 
 #include "TwoBodyDecayGen.hxx"
+#include "TemplateBuilder.hxx"
+#include "RootAdapter.hxx"
 
 
 // some constants
@@ -20,15 +21,21 @@ static const double BSMASS(5366.3), DSMASS(1968.49), KMASS(493.677),
 
 void usage(char * prog)
 {
-  std::cout << "Usage: $ " << prog << " <nevents> <mode>"
+  std::cout << "Usage: $ " << prog << " <nevents> <mode> [codec[:level]]"
     " # args are case sensitive" << std::endl;
+  std::cout << "Codecs: zlib, lzma, lz4, zstd; baskets are compressed on 4"
+    " threads" << std::endl;
+  std::cout << "The event tree keeps the particle_lvs layout and is still"
+    " filled on the generating thread," << std::endl;
+  std::cout << "so writing holds back generation; see writebench for flat"
+    " trees written on their own thread" << std::endl;
 }
 
 
 int main(int argc, char* argv[])
 {
   // program arguments
-  if (argc > 3) {
+  if (argc > 4) {
     std::cout << "Too many arguments!" << std::endl;
     usage(argv[0]);
     return -1;
@@ -36,32 +43,45 @@ int main(int argc, char* argv[])
 
   int nevents(100);
   std::string mode;
-  if (argc == 3) {
+  RootAdapter::OutputSettings settings;
+  bool tuned(false);
+  if (argc >= 3) {
     nevents = atol(argv[1]);
     mode = argv[2];
+    if (argc == 4) {
+      if (not settings.parse(argv[3])) {
+	usage(argv[0]);
+	return -1;
+      }
+      settings.set_threads(4);
+      tuned = true;
+    }
   } else {
     std::cout << "Not enough arguments!" << std::endl;
     usage(argv[0]);
     return -1;
   }
 
-  // read ntuple from file
+  // make templates from ntuple (cached between runs)
   std::string fname = "smalltree-" + mode + ".root";
-  TFile infile(fname.c_str(), "read");
-  TTree *intree = dynamic_cast<TTree*>(infile.Get("ftree"));
-
-  // make dataset from histogram
   TH1D Bsmomp("Bsmomp", "", 100, 0.0, 300.0);
-  intree->Draw("1E-3*tru_BsMom.P()>>Bsmomp");
-  gPad->Print("Bs_mom_template.png");
-
   TH1D Bsmomn("Bsmomn", "", 100, 1.0, 6.0);
-  intree->Draw("tru_BsMom.Eta()>>Bsmomn");
-  gPad->Print("Bs_eta_template.png");
+
+  TemplateBuilder builder(fname, "ftree", "tru_BsMom", 1E-3);
+  builder.set_cache("templates-cache.root");
+  builder.set_threads(4);
+  if (not builder.build(&Bsmomp, &Bsmomn)) {
+    std::cout << "Could not read ftree from " << fname << std::endl;
+    return -1;
+  }
 
   // ROOT file dump
   fname = "eventtree-" + mode + ".root";
   TFile *file = new TFile(fname.c_str(), "recreate");
+  if (tuned) {
+    settings.apply(file);
+    settings.enable_threads();
+  }
   file->cd();
 
   // generator config
@@ -106,7 +126,11 @@ int main(int argc, char* argv[])
   }
   generator.print();
 
-  // generate, print summary and dump to ROOT file
+  // generate, print summary and dump to ROOT file; the tree has the
+  // usual vector<TLorentzVector> layout read by test and testpartial.
+  // It is still filled on the generating thread: TTree::Fill (and
+  // the basket flushes it triggers) blocks generation, only the
+  // compression of the flushed baskets runs on helper threads.
   TTree* eventtree = generator.get_event_tree(nevents, &Bsmomp, &Bsmomn);
   eventtree->Print("all");
   file->WriteTObject(eventtree);
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include <TFile.h>
+#include <TH1D.h>
+
+#include "DecayGenCore.hxx"
+#include "HistogramGen.hxx"
+#include "Observables.hxx"
+#include "TemplateBuilder.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), KMASS(493.677),
+  PIMASS(139.57018), DSSTMASS(2112.34);
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " <nevents> <mode> [nthreads]"
+    " # args are case sensitive" << std::endl;
+  std::cout << "Fills the generated momentum and k-factor histograms of test"
+    " without an event tree" << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc != 3 and argc != 4) {
+    std::cout << "Wrong number of arguments!" << std::endl;
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned long nevents(atol(argv[1]));
+  std::string mode(argv[2]);
+  unsigned nthreads(argc == 4 ? atoi(argv[3]) : 4);
+
+  // make templates from ntuple (cached between runs), as in generator
+  std::string fname = "smalltree-" + mode + ".root";
+  TH1D Bsmomp("Bsmomp", "", 100, 0.0, 300.0);
+  TH1D Bsmomn("Bsmomn", "", 100, 1.0, 6.0);
+
+  TemplateBuilder builder(fname, "ftree", "tru_BsMom", 1E-3);
+  builder.set_cache("templates-cache.root");
+  builder.set_threads(nthreads);
+  if (not builder.build(&Bsmomp, &Bsmomn)) {
+    std::cout << "Could not read ftree from " << fname << std::endl;
+    return -1;
+  }
+
+  // same decay trees as generator
+  std::vector<double> masses, masses2;
+  masses.push_back(BSMASS * 1E-3);
+  if ("DsK" == mode) {
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(KMASS * 1E-3);
+  } else if ("DsPi" == mode) {
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+  } else if ("DsstPi" == mode) {
+    masses.push_back(DSSTMASS * 1E-3);
+    masses.push_back(PIMASS * 1E-3);
+    masses.push_back(DSMASS * 1E-3);
+    masses.push_back(0.0);
+    masses2 = masses;
+    masses2.back() = PIMASS * 1E-3;
+  } else {
+    std::cout << "Unknown mode: " << mode << std::endl;
+    usage(argv[0]);
+    return -1;
+  }
+
+  DecayGenCore generator(&masses[0], masses.size());
+  if (not masses2.empty()) {
+    generator.add_decay_channel(&masses2[0], masses2.size(), 0.05);
+  }
+
+  // generated histograms of test: momenta, and k-factors with the
+  // bachelor as a kaon
+  TH1D hBs("hgen_Bs_mom", "Bs momentum", 100, 0.0, 300.0);
+  TH1D hdau1("hgen_dau1_mom", "Dau1 momentum", 100, 0.0, 300.0);
+  TH1D hdau2("hgen_dau2_mom", "Dau2 momentum", 100, 0.0, 300.0);
+  TH1D kfactorm("kfactortrum", "k-factor (m)", 1000, 0.85, 1.05);
+  TH1D kfactorp("kfactortrup", "k-factor (p)", 1000, 0.85, 1.05);
+  TH1D kfactorpm("kfactortrupm", "k-factor", 1000, 0.85, 1.05);
+
+  MomentumObservable pBs(0), pdau1(1), pdau2(2);
+  KFactorObservable km(1, 2, KMASS * 1E-3, KFactorObservable::MASS),
+    kp(1, 2, KMASS * 1E-3, KFactorObservable::MOMENTUM),
+    kpm(1, 2, KMASS * 1E-3, KFactorObservable::BOTH);
+
+  HistogramGen histgen(generator);
+  histgen.add_histogram(&hBs, &pBs);
+  histgen.add_histogram(&hdau1, &pdau1);
+  histgen.add_histogram(&hdau2, &pdau2);
+  histgen.add_histogram(&kfactorm, &km);
+  histgen.add_histogram(&kfactorp, &kp);
+  histgen.add_histogram(&kfactorpm, &kpm);
+
+  histgen.fill(nevents, &Bsmomp, &Bsmomn, nthreads); // prints tried / accepted
+  std::cout << "k-factor mean: " << kfactorpm.GetMean() << ", RMS: "
+	    << kfactorpm.GetRMS() << std::endl;
+
+  // only the histograms are saved
+  fname = "histograms-" + mode + ".root";
+  TFile file(fname.c_str(), "recreate");
+  file.WriteTObject(&hBs);
+  file.WriteTObject(&hdau1);
+  file.WriteTObject(&hdau2);
+  file.WriteTObject(&kfactorm);
+  file.WriteTObject(&kfactorp);
+  file.WriteTObject(&kfactorpm);
+  file.Close();
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file   DecayGenModule.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cernNOSPAM.ch>
+ * @date   Mon Oct 19 14:05:51 2026
+ *
+ * @brief  Python bindings for the decay generator
+ *
+ * Events are generated in batches directly into NumPy arrays owned by
+ * the caller.  The module is built on the ROOT independent core
+ * (DecayGenCore), so importing it does not load ROOT.  Example:
+ *
+ *     import numpy as np
+ *     import DecayGen
+ *     gen = DecayGen.TwoBodyDecayGen([5.3663, 1.96849, 0.493677])
+ *     moms = np.zeros((1000, 4)); moms[:, 2] = 100.0
+ *     moms[:, 3] = np.sqrt(100.0**2 + 5.3663**2)
+ *     parts = np.empty((1000, gen.get_nparticles(), 4))
+ *     wts = np.empty(1000)
+ *     gen.generate_batch(moms, parts, wts)
+ *
+ */
+
+// STL headers
+#include <vector>
+#include <string>
+
+// Boost headers
+#include <boost/shared_ptr.hpp>
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
+// package headers
+#include "DecayGenCore.hxx"
+
+
+namespace bp = boost::python;
+namespace np = boost::python::numpy;
+
+
+/**
+ * Convert a Python sequence of numbers to a std::vector
+ *
+ * @param seq Python sequence
+ *
+ * @return Vector of doubles
+ */
+static std::vector<double> to_vector(bp::object seq)
+{
+  return std::vector<double>(bp::stl_input_iterator<double>(seq),
+			     bp::stl_input_iterator<double>());
+}
+
+
+/**
+ * Raise a Python ValueError
+ *
+ * @param msg Error message
+ */
+static void raise_value_error(std::string msg)
+{
+  PyErr_SetString(PyExc_ValueError, msg.c_str());
+  bp::throw_error_already_set();
+}
+
+
+/**
+ * Check that an array can be written to (or read from) in place
+ *
+ * @param arr Array to check
+ * @param dtype Expected element type
+ * @param shape Expected shape
+ * @param name Argument name for error messages
+ */
+static void check_array(np::ndarray const &arr, np::dtype const &dtype,
+			std::vector<Py_intptr_t> const &shape, std::string name)
+{
+  if (arr.get_dtype() != dtype) {
+    raise_value_error(name + ": wrong dtype");
+  }
+  if (not (arr.get_flags() & np::ndarray::C_CONTIGUOUS)) {
+    raise_value_error(name + ": array must be C contiguous");
+  }
+  if (arr.get_nd() != int(shape.size())) {
+    raise_value_error(name + ": wrong number of dimensions");
+  }
+  for (unsigned i = 0; i < shape.size(); ++i) {
+    if (arr.shape(i) != shape[i]) {
+      raise_value_error(name + ": wrong shape");
+    }
+  }
+}
+
+
+static boost::shared_ptr<DecayGenCore> make_generator(bp::object masses)
+{
+  std::vector<double> vmasses(to_vector(masses));
+  if (vmasses.size() < 3 or vmasses.size() % 2 == 0) {
+    raise_value_error("masses: need an odd number (≥ 3) of particle masses");
+  }
+  return boost::shared_ptr<DecayGenCore>
+    (new DecayGenCore(&vmasses[0], vmasses.size()));
+}
+
+
+static bool add_decay_channel(DecayGenCore &gen, bp::object masses,
+			      double brfr)
+{
+  std::vector<double> vmasses(to_vector(masses));
+  if (vmasses.size() < 3 or vmasses.size() % 2 == 0) {
+    raise_value_error("masses: need an odd number (≥ 3) of particle masses");
+  }
+  return gen.add_decay_channel(&vmasses[0], vmasses.size(), brfr);
+}
+
+
+static void print_tree(DecayGenCore &gen)
+{
+  gen.print();
+}
+
+
+static unsigned generate_batch(DecayGenCore &gen, np::ndarray mothers,
+			       np::ndarray particles, np::ndarray weights,
+			       bp::object channels)
+{
+  if (mothers.get_nd() != 2) {
+    raise_value_error("mothers: wrong number of dimensions");
+  }
+  const Py_intptr_t nevents(mothers.shape(0));
+  std::vector<Py_intptr_t> shape;
+
+  shape.push_back(nevents);
+  shape.push_back(4);
+  check_array(mothers, np::dtype::get_builtin<double>(), shape, "mothers");
+
+  shape.back() = gen.get_nparticles();
+  shape.push_back(4);
+  check_array(particles, np::dtype::get_builtin<double>(), shape, "particles");
+
+  shape.resize(1);
+  check_array(weights, np::dtype::get_builtin<double>(), shape, "weights");
+
+  unsigned *chptr(NULL);
+  if (not channels.is_none()) {
+    np::ndarray charr = bp::extract<np::ndarray>(channels);
+    check_array(charr, np::dtype::get_builtin<unsigned>(), shape, "channels");
+    chptr = reinterpret_cast<unsigned*>(charr.get_data());
+  }
+
+  return gen.generate_batch(nevents,
+			    reinterpret_cast<double*>(mothers.get_data()),
+			    reinterpret_cast<double*>(particles.get_data()),
+			    reinterpret_cast<double*>(weights.get_data()),
+			    chptr);
+}
+
+
+BOOST_PYTHON_MODULE(DecayGen)
+{
+  np::initialize();
+
+  bp::class_<DecayGenCore, boost::shared_ptr<DecayGenCore>,
+    boost::noncopyable>("TwoBodyDecayGen",
+			"Sequential 2-body decay tree (see DecayGenCore.hxx)",
+			bp::no_init)
+    .def("__init__", bp::make_constructor(&make_generator),
+	 "Construct from a sequence with masses of all particles in GeV/c²")
+    .def("add_decay_channel", &add_decay_channel,
+	 (bp::arg("masses"), bp::arg("brfr")),
+	 "Add a new decay channel with branching fraction brfr")
+    .def("print", &print_tree, "Print decay tree")
+    .def("get_nparticles",
+	 static_cast<unsigned (DecayGenCore::*)() const>
+	 (&DecayGenCore::get_nparticles),
+	 "Number of particles (including mother) in the largest channel")
+    .def("set_seed", &DecayGenCore::set_seed, bp::arg("seed"),
+	 "Set seed of the random number generator")
+    .def("set_full_acceptance", &DecayGenCore::set_full_acceptance,
+	 bp::arg("full") = true,
+	 "Require all final-state particles (not only the last of each\n"
+	 "leaf vertex) inside the acceptance")
+    .def("set_early_rejection", &DecayGenCore::set_early_rejection,
+	 bp::arg("early") = true,
+	 "Reject events on the first particle outside acceptance, instead\n"
+	 "of after the whole decay")
+    .def("generate_batch", &generate_batch,
+	 (bp::arg("mothers"), bp::arg("particles"), bp::arg("weights"),
+	  bp::arg("channels") = bp::object()),
+	 "Generate into caller owned arrays: mothers (n, 4) float64,\n"
+	 "particles (n, nparticles, 4) float64, weights (n,) float64 and\n"
+	 "optionally channels (n,) uint32.  Returns number of events with\n"
+	 "positive weight.");
+}
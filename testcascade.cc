@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include <TRandom3.h>
+#include <TLorentzVector.h>
+
+#include "TwoBodyDecayGen.hxx"
+#include "DecayGenCore.hxx"
+#include "EquivalenceTest.hxx"
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " [<nevents> <max depth>]" << std::endl;
+  std::cout << "Checks 4-momentum conservation and daughter masses at every"
+    " vertex of TwoBodyDecayGen::generate" << std::endl;
+}
+
+
+/**
+ * Check every vertex of events generated by TwoBodyDecayGen::generate
+ *
+ * The vertex layout (daughters of vertex i are particles 2i + 1 and
+ * 2i + 2) is taken from DecayGenCore, built from the same masses.
+ *
+ * @param masses Particle masses in GeV/c²
+ * @param nevents Number of tried events
+ *
+ * @return Number of events with a wrong vertex
+ */
+unsigned long check_cascade(std::vector<double> masses, unsigned long nevents)
+{
+  TwoBodyDecayGen generator(&masses[0], masses.size());
+  DecayGenCore core(&masses[0], masses.size());
+  const std::vector<DecayGenCore::Vertex>
+    &vertices(core.get_channel(0).vertices);
+
+  // single channel, the deepest leaf branch decays the whole tree
+  std::vector<std::deque<TwoBodyDecayGen::chBFpair> > brfrVec;
+  std::deque<TwoBodyDecayGen::chBFpair> brfrQ, chQ;
+  generator.find_leaf_nodes(brfrVec, brfrQ);
+  for (unsigned i = 0; i < brfrVec.size(); ++i) {
+    if (brfrVec[i].size() > chQ.size()) chQ = brfrVec[i];
+  }
+
+  std::vector<TLorentzVector> particle_lvs;
+  TLorentzVector momp;
+  unsigned long nchecked(0), nwrong(0);
+  for (unsigned long evt = 0; evt < nevents; ++evt) {
+    momp.SetPtEtaPhiM(gRandom->Uniform(1.0, 20.0), gRandom->Uniform(2.0, 5.0),
+		      gRandom->Uniform(0.0, 2 * M_PI), masses[0]);
+    particle_lvs.clear();
+    particle_lvs.push_back(momp);
+    if (not (generator.generate(momp, particle_lvs, chQ) > 0)) continue;
+    nchecked++;
+
+    bool good(particle_lvs.size() == core.get_nparticles(0));
+    for (unsigned i = 0; good and i < vertices.size(); ++i) {
+      const TLorentzVector &mother(particle_lvs[vertices[i].mother]);
+      TLorentzVector sum(particle_lvs[2*i + 1] + particle_lvs[2*i + 2]);
+      good = (sum - mother).P() < 1E-6 * mother.E() and
+	std::fabs(sum.E() - mother.E()) < 1E-6 * mother.E();
+      for (unsigned j = 0; good and j < NDAUS; ++j) {
+	good = std::fabs(particle_lvs[2*i + 1 + j].M() -
+			 vertices[i].daumasses[j]) < 1E-4;
+      }
+    }
+    if (not good) nwrong++;
+  }
+
+  std::cout << masses.size() << " particles: " << nchecked
+	    << " accepted events checked, " << nwrong << " wrong" << std::endl;
+  if (nchecked == 0) nwrong++;	// nothing checked is a failure too
+  return nwrong;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc != 1 and argc != 3) {
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned long nevents(argc == 3 ? atol(argv[1]) : 10000);
+  unsigned maxdepth(argc == 3 ? atoi(argv[2]) : 4);
+
+  // TGenPhaseSpace uses gRandom
+  gRandom = new TRandom3(4357);
+
+  // one level cascades were never affected, deeper ones decayed the
+  // first level daughters again (particle_lvs[j+1]) at every node
+  unsigned long nfailed(0);
+  for (unsigned depth = 1; depth <= maxdepth; ++depth) {
+    for (unsigned i = 0; i < 3; ++i) {
+      nfailed += check_cascade(EquivalenceTest::random_cascade(depth,
+							       10 * depth + i),
+			       nevents);
+    }
+  }
+
+  std::cout << (nfailed ? "FAIL" : "PASS") << ": " << nfailed
+	    << " wrong event(s)." << std::endl;
+  return nfailed ? 1 : 0;
+}
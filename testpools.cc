@@ -0,0 +1,167 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+
+#include <TH1D.h>
+#include <TTree.h>
+#include <TSystem.h>
+
+#include "TwoBodyDecayGen.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), PIMASS(139.57018),
+  DSSTMASS(2112.34);
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " [<pool events> <mixture events>]"
+	    << std::endl;
+  std::cout << "Writes DsstPi event pools, mixes them for several branching"
+    " fractions and checks the per channel counts and weights" << std::endl;
+}
+
+
+/**
+ * Mix event pools and check every leaf branch
+ *
+ * Each leaf branch has to have min(npool, eff_brfr·nevents) entries,
+ * or npool without subsampling, and its bf_wt have to add up to
+ * eff_brfr·nevents (rounded down, like get_event_mixture).
+ *
+ * @param generator Decay tree the pools were written for
+ * @param fname Event pool file
+ * @param npool Number of events in each pool
+ * @param nevents Number of events of the mixture
+ * @param hmomp Mother momentum template
+ * @param hmomn Mother η template
+ * @param subsample Use only as many pool events as needed
+ *
+ * @return Number of leaf branches that are wrong
+ */
+unsigned check_mixture(TwoBodyDecayGen &generator, std::string fname,
+		       unsigned npool, unsigned nevents, TH1 *hmomp, TH1 *hmomn,
+		       bool subsample)
+{
+  TTree *mixture = generator.get_event_mixture(fname, nevents, hmomp, hmomn,
+					       subsample);
+  if (not mixture) {
+    std::cout << "No mixture" << std::endl;
+    return 1;
+  }
+
+  // branch addresses still point to variables of get_event_mixture
+  double bf_wt(0.0);
+  mixture->ResetBranchAddresses();
+  mixture->SetBranchStatus("*", 0);
+  mixture->SetBranchStatus("bf_wt", 1);
+  mixture->SetBranchAddress("bf_wt", &bf_wt);
+
+  std::vector<std::deque<TwoBodyDecayGen::chBFpair> > brfrVec;
+  std::deque<TwoBodyDecayGen::chBFpair> brfrQ;
+  generator.find_leaf_nodes(brfrVec, brfrQ);
+
+  unsigned nwrong(0);
+  for (unsigned chid = 0; chid < brfrVec.size(); ++chid) {
+    double eff_brfr(1.0);
+    for (unsigned i = 0; i < brfrVec[chid].size(); ++i) {
+      eff_brfr *= brfrVec[chid][i].second;
+    }
+    unsigned eff_nevents(eff_brfr * nevents);
+    Long64_t expected(subsample ? std::min(npool, eff_nevents) : npool);
+
+    Long64_t first(0), nentries(0);
+    double sum(0.0);
+    if (TwoBodyDecayGen::get_channel_entries(mixture, chid, first,
+					     nentries)) {
+      for (Long64_t evt = first; evt < first + nentries; ++evt) {
+	mixture->GetEntry(evt);
+	sum += bf_wt;
+      }
+    }
+
+    bool good(nentries == expected and
+	      std::fabs(sum - eff_nevents) <= 1E-9 * eff_nevents);
+    std::cout << "  channel "
+	      << TwoBodyDecayGen::get_channel_path(brfrVec[chid]) << ": BF "
+	      << eff_brfr << ", " << nentries << " entries ("
+	      << expected << " expected), sum(bf_wt) " << sum << " ("
+	      << eff_nevents << " expected)" << (good ? "" : "  WRONG")
+	      << std::endl;
+    if (not good) nwrong++;
+  }
+
+  delete mixture;
+  return nwrong;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc != 1 and argc != 3) {
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned npool(argc == 3 ? atoi(argv[1]) : 20000);
+  unsigned nevents(argc == 3 ? atoi(argv[2]) : 100000);
+
+  // smooth mother templates, as in validate
+  TH1D Bsmomp("Bsmomp", "", 100, 0.0, 300.0);
+  TH1D Bsmomn("Bsmomn", "", 100, 1.0, 6.0);
+  for (int i = 1; i <= 100; ++i) {
+    double p(Bsmomp.GetBinCenter(i)), eta(Bsmomn.GetBinCenter(i));
+    Bsmomp.SetBinContent(i, p * std::exp(-p / 30.0));
+    Bsmomn.SetBinContent(i, std::exp(-0.5 * std::pow((eta - 3.2) / 0.8, 2)));
+  }
+
+  // DsstPi as in generator: Ds* → Ds γ, and Ds* → Ds π at the root
+  double masses[5] = {BSMASS * 1E-3, DSSTMASS * 1E-3, PIMASS * 1E-3,
+		      DSMASS * 1E-3, 0.0};
+  double masses2[5] = {BSMASS * 1E-3, DSSTMASS * 1E-3, PIMASS * 1E-3,
+		       DSMASS * 1E-3, PIMASS * 1E-3};
+  TwoBodyDecayGen Bs(masses, 5);
+  Bs.add_decay_channel(masses2, 5, 0.05);
+
+  std::string fname("testpools.root");
+  gSystem->Unlink(fname.c_str());
+  if (not Bs.write_event_pools(fname, npool, &Bsmomp, &Bsmomn)) {
+    std::cout << "FAIL: could not write event pools." << std::endl;
+    return 1;
+  }
+
+  // the pools are reused when the BF changes
+  unsigned nwrong(0);
+  const double brfrs[3] = {0.05, 0.01, 0.5};
+  for (unsigned i = 0; i < 3; ++i) {
+    if (not Bs.set_brfr(1, brfrs[i])) nwrong++;
+    std::cout << "BF(Ds* -> Ds pi) = " << brfrs[i] << ", subsampled:"
+	      << std::endl;
+    nwrong += check_mixture(Bs, fname, npool, nevents, &Bsmomp, &Bsmomn,
+			    true);
+    std::cout << "BF(Ds* -> Ds pi) = " << brfrs[i] << ", all pool events:"
+	      << std::endl;
+    nwrong += check_mixture(Bs, fname, npool, nevents, &Bsmomp, &Bsmomn,
+			    false);
+  }
+
+  // pools of other templates are not reused, even with the same name
+  TH1D Bsmomp2(Bsmomp);
+  Bsmomp2.SetBinContent(50, 2 * Bsmomp2.GetBinContent(50));
+  std::cout << "Changed momentum template (expect an error):" << std::endl;
+  TTree *stale = Bs.get_event_mixture(fname, nevents, &Bsmomp2, &Bsmomn);
+  if (stale) {
+    std::cout << "  stale pools were used  WRONG" << std::endl;
+    delete stale;
+    nwrong++;
+  }
+
+  gSystem->Unlink(fname.c_str());
+  std::cout << (nwrong ? "FAIL" : "PASS") << ": " << nwrong
+	    << " wrong check(s)." << std::endl;
+  return nwrong ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <sstream>
+#include <cmath>
+
+#include <TH1D.h>
+
+#include "EquivalenceTest.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), KMASS(493.677),
+  PIMASS(139.57018), DSSTMASS(2112.34);
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " <nevents> [<max depth> <ncascades>]"
+	    << std::endl;
+}
+
+
+/**
+ * Compare the reference and core generators for one decay tree
+ *
+ * @param name Decay tree name
+ * @param masses Particle masses in GeV/c²
+ * @param nevents Number of events per generator and channel
+ * @param hmomp Mother momentum template
+ * @param hmomn Mother η template
+ * @param masses2 Particle masses of a second channel (none if empty)
+ * @param brfr2 Branching fraction of the second channel
+ *
+ * @return Verdict
+ */
+bool validate(std::string name, std::vector<double> masses,
+	      unsigned long nevents, TH1 *hmomp, TH1 *hmomn,
+	      std::vector<double> masses2=std::vector<double>(),
+	      double brfr2=0.0)
+{
+  std::cout << "== " << name << " (" << masses.size() << " particles)"
+	    << std::endl;
+  EquivalenceTest test(&masses[0], masses.size(), hmomp, hmomn);
+  if (not masses2.empty()) {
+    test.add_decay_channel(&masses2[0], masses2.size(), brfr2);
+  }
+  bool pass(test.run(nevents));
+  test.print();
+  return pass;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc != 2 and argc != 4) {
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned long nevents(atol(argv[1]));
+  unsigned maxdepth(argc == 4 ? atoi(argv[2]) : 4);
+  unsigned ncascades(argc == 4 ? atoi(argv[3]) : 3);
+
+  // smooth mother templates, similar to the ntuples
+  TH1D Bsmomp("Bsmomp", "", 100, 0.0, 300.0);
+  TH1D Bsmomn("Bsmomn", "", 100, 1.0, 6.0);
+  for (int i = 1; i <= 100; ++i) {
+    double p(Bsmomp.GetBinCenter(i)), eta(Bsmomn.GetBinCenter(i));
+    Bsmomp.SetBinContent(i, p * std::exp(-p / 30.0));
+    Bsmomn.SetBinContent(i, std::exp(-0.5 * std::pow((eta - 3.2) / 0.8, 2)));
+  }
+
+  // generator.cc modes, DsstPi with both Ds* channels
+  double modes[3][5] = {
+    {BSMASS, DSMASS, KMASS},
+    {BSMASS, DSMASS, PIMASS},
+    {BSMASS, DSSTMASS, PIMASS, DSMASS, 0.0}
+  };
+  const char *names[3] = {"DsK", "DsPi", "DsstPi"};
+  const unsigned nparts[3] = {3, 3, 5};
+
+  unsigned nfailed(0);
+  for (unsigned m = 0; m < 3; ++m) {
+    std::vector<double> masses, masses2;
+    for (unsigned i = 0; i < nparts[m]; ++i) masses.push_back(modes[m][i] * 1E-3);
+    if ("DsstPi" == std::string(names[m])) {
+      masses2 = masses;
+      masses2.back() = PIMASS * 1E-3;
+    }
+    if (not validate(names[m], masses, nevents, &Bsmomp, &Bsmomn, masses2,
+		     0.05)) {
+      nfailed++;
+    }
+  }
+
+  // random deep cascades
+  for (unsigned depth = 2; depth <= maxdepth; ++depth) {
+    for (unsigned i = 0; i < ncascades; ++i) {
+      std::ostringstream name;
+      name << "cascade depth " << depth << " #" << i;
+      if (not validate(name.str(),
+		       EquivalenceTest::random_cascade(depth, 100 * depth + i),
+		       nevents, &Bsmomp, &Bsmomn)) {
+	nfailed++;
+      }
+    }
+  }
+
+  std::cout << (nfailed ? "FAIL" : "PASS") << ": " << nfailed
+	    << " decay tree(s) differ." << std::endl;
+  return nfailed ? 1 : 0;
+}
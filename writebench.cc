@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TSystem.h>
+
+#include "DecayGenCore.hxx"
+#include "TemplateSampler.hxx"
+#include "PipelineGen.hxx"
+#include "RootAdapter.hxx"
+#include "WallClock.hxx"
+
+
+// some constants
+static const double BSMASS(5366.3), DSMASS(1968.49), PIMASS(139.57018),
+  DSSTMASS(2112.34);
+
+
+void usage(char * prog)
+{
+  std::cout << "Usage: $ " << prog << " <nevents> [nthreads]" << std::endl;
+  std::cout << "Compares write throughput and file size of the event tree"
+    " (DsstPi) with default settings and flat trees with several codecs"
+	    << std::endl;
+}
+
+
+/**
+ * Generate events in a pipeline and write them to a file
+ *
+ * @param fname Output file
+ * @param generator Generator
+ * @param nevents Number of events
+ * @param settings Output settings (NULL for the default tree and settings)
+ * @param ref Reference time and size, set when settings is NULL
+ */
+void bench(std::string fname, const DecayGenCore &generator,
+	   unsigned long nevents, const RootAdapter::OutputSettings *settings,
+	   double ref[2])
+{
+  std::vector<double> flat(100, 1.0);
+  TemplateSampler Bsmomp(100, 0.0, 300.0, &flat[0]);
+  TemplateSampler Bsmomn(100, 1.0, 6.0, &flat[0]);
+
+  double start(walltime());
+  TFile file(fname.c_str(), "recreate");
+  if (settings) settings->apply(&file);
+  TTree *tree = new TTree("events", "Generated events");
+
+  EventSink *sink(NULL);
+  if (settings) {
+    sink = new RootAdapter::FlatTreeSink(tree, generator.get_nparticles(),
+					 settings);
+  } else {
+    sink = new RootAdapter::TreeSink(tree);
+  }
+
+  // the tree is filled (and compressed) on the serialisation thread
+  PipelineGen pipeline(generator);
+  pipeline.generate(nevents, Bsmomp, &Bsmomn, *sink);
+  double totbytes(tree->GetTotBytes());
+  file.WriteTObject(tree);
+  file.Close();
+  double elapsed(walltime() - start);
+  delete sink;
+
+  Long_t id(0), flags(0), modtime(0);
+  Long64_t size(0);
+  gSystem->GetPathInfo(fname.c_str(), &id, &size, &flags, &modtime);
+
+  const PipelineGen::StageStats &writer(pipeline.get_stats().back());
+  if (not settings) {
+    ref[0] = elapsed;
+    ref[1] = size;
+  }
+  std::cout << std::setw(26) << std::left
+	    << (settings ? "flat " + settings->str() : "current (default)")
+	    << std::right << std::setprecision(4)
+	    << std::setw(12) << nevents / elapsed
+	    << std::setw(10) << totbytes / elapsed / 1E6
+	    << std::setw(10) << size / 1E6
+	    << std::setw(10) << size / ref[1]
+	    << std::setw(10) << ref[0] / elapsed
+	    << std::setw(10) << 100 * writer.stalltime / writer.walltime
+	    << std::endl;
+  return;
+}
+
+
+int main(int argc, char* argv[])
+{
+  // program arguments
+  if (argc != 2 and argc != 3) {
+    std::cout << "Wrong number of arguments!" << std::endl;
+    usage(argv[0]);
+    return -1;
+  }
+  unsigned long nevents(atol(argv[1]));
+  unsigned nthreads(argc == 3 ? atoi(argv[2]) : 4);
+
+  double masses[5] = {BSMASS * 1E-3, DSSTMASS * 1E-3, PIMASS * 1E-3,
+		      DSMASS * 1E-3, 0.0};
+  double masses2[5] = {BSMASS * 1E-3, DSSTMASS * 1E-3, PIMASS * 1E-3,
+		       DSMASS * 1E-3, PIMASS * 1E-3};
+  DecayGenCore generator(masses, 5);
+  generator.add_decay_channel(masses2, 5, 0.05);
+
+  std::cout << std::setw(26) << std::left << "Output" << std::right
+	    << std::setw(12) << "events/s" << std::setw(10) << "MB/s"
+	    << std::setw(10) << "size [MB]" << std::setw(10) << "ratio"
+	    << std::setw(10) << "speed-up" << std::setw(10) << "idle [%]"
+	    << std::endl;
+
+  double ref[2] = {1.0, 1.0};
+  bench("writebench-default.root", generator, nevents, NULL, ref);
+
+  // from here on, all trees are compressed on the helper threads
+  const char *specs[4] = {"zlib:1", "lz4:4", "zstd:5", "lzma:1"};
+  for (unsigned i = 0; i < 4; ++i) {
+    RootAdapter::OutputSettings settings;
+    settings.parse(specs[i]);
+    settings.set_threads(nthreads);
+    if (i == 0) settings.enable_threads();
+    std::string fname(std::string("writebench-") + specs[i] + ".root");
+    fname[fname.find(':')] = '-';
+    bench(fname, generator, nevents, &settings, ref);
+  }
+  return 0;
+}